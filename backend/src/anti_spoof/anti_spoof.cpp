@@ -1,7 +1,8 @@
 #include "anti_spoof.hpp"
     
 AntiSpoofing::AntiSpoofing(const std::string& modelPath, float threshold)
-    : threshold_(threshold)
+    : threshold_(threshold),
+      preprocessor_(cv::Size(224, 224), NormalizeParams::affine(1.0f / 255.0f, 0.0f))
 {
     net_ = cv::dnn::readNetFromONNX(modelPath);
     if (net_.empty())
@@ -28,25 +29,8 @@ bool AntiSpoofing::isSpoof(const cv::Mat& faceRoi, float& scoreOut)
 
 cv::Mat AntiSpoofing::preprocess(const cv::Mat& faceRoi)
 {
-    cv::Mat resized, rgb, floatImg;
-
-    // Resize ke 224x224
-    cv::resize(faceRoi, resized, cv::Size(224, 224));
-
-    // BGR -> RGB
-    cv::cvtColor(resized, rgb, cv::COLOR_BGR2RGB);
-
-    // Normalize [0, 1]
-    rgb.convertTo(floatImg, CV_32FC3, 1.0 / 255.0);
-
-    // blobFromImage: HWC -> NCHW [1, 3, 224, 224]
-    // swapRB=false karena sudah convert manual
-    return cv::dnn::blobFromImage(
-        floatImg,
-        1.0,
-        cv::Size(224, 224),
-        cv::Scalar(0, 0, 0),
-        false,   // swapRB
-        false    // crop
-    );
+    const int dims[4] = {1, 3, 224, 224};
+    float* blob = inputBuffer_.reserve(preprocessor_.tensorSize());
+    preprocessor_.run(faceRoi, blob);
+    return cv::Mat(4, dims, CV_32F, blob);
 }
@@ -4,6 +4,8 @@
 #include <opencv2/dnn.hpp>
 #include <stdexcept>
 
+#include "inference/preprocess.hpp"
+
 class AntiSpoofing
 {
 public:
@@ -29,10 +31,13 @@ public:
 private:
     cv::dnn::Net net_;
     float threshold_;
+    ImagePreprocessor preprocessor_;
+    TensorBuffer inputBuffer_;
 
-    // Preprocessing sesuai training:
+    // Preprocessing sesuai training (satu pass, lihat ImagePreprocessor):
     //   - resize ke 224x224
     //   - BGR -> RGB
     //   - normalize [0, 1]
+    // Return header [1, 3, 224, 224] di atas inputBuffer_ (valid sampai panggilan berikutnya)
     cv::Mat preprocess(const cv::Mat& faceRoi);
 };
\ No newline at end of file
@@ -1,39 +1,46 @@
 #include "depth_anything.hpp"
+#include "debug/debug_sink.hpp"
+#include <algorithm>
+
+DepthInputMode parseDepthInputMode(const std::string& mode)
+{
+    if (mode == "roi") return DepthInputMode::Roi;
+    if (mode != "full") {
+        printf("[DepthAntiSpoofing] Unknown input mode '%s', using 'full'\n", mode.c_str());
+    }
+    return DepthInputMode::Full;
+}
 
 DepthAntiSpoofing::DepthAntiSpoofing(float flatThreshold) 
 :   flatThreshold_(flatThreshold),
-    env_(ORT_LOGGING_LEVEL_WARNING, "DepthAntiSpoofing"),
-    session_(nullptr),
     inputH_(0),
-    inputW_(0)
+    inputW_(0),
+    session_(nullptr)
 {}
 
 DepthAntiSpoofing::DepthAntiSpoofing(const std::string& modelPath, float flatThreshold)
-    : flatThreshold_(flatThreshold),
-        env_(ORT_LOGGING_LEVEL_WARNING, "DepthAntiSpoofing"),
-        session_(nullptr)
+:   DepthAntiSpoofing(flatThreshold)
 {
-    Ort::SessionOptions opts;
-    opts.SetIntraOpNumThreads(1);
-    opts.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
-    session_ = Ort::Session(env_, modelPath.c_str(), opts);
-
-    // Auto-detect input size dari model — tidak perlu hardcode
-    auto inputShape = session_.GetInputTypeInfo(0)
-                        .GetTensorTypeAndShapeInfo().GetShape();
-    // inputShape: [1, 3, H, W]
-    inputH_ = static_cast<int>(inputShape[2]);
-    inputW_ = static_cast<int>(inputShape[3]);
-    printf("[DepthAntiSpoofing] Input size: %dx%d. threshold : %.2f\n", inputW_, inputH_, flatThreshold);
+    if (!LoadModel(modelPath, flatThreshold)) {
+        throw std::runtime_error("DepthAntiSpoofing: cannot load " + modelPath);
+    }
 }
 
-bool DepthAntiSpoofing::LoadModel(const std::string& modelPath, float flatThreshold)
+bool DepthAntiSpoofing::LoadModel(const std::string& modelPath, float flatThreshold, const InferenceOptions& options)
 {
     try {
-        Ort::SessionOptions opts;
-        opts.SetIntraOpNumThreads(1);
-        opts.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
-        session_ = Ort::Session(env_, modelPath.c_str(), opts);
+        if (!options.useOrt()) {
+            printf("[DepthAntiSpoofing] Backend '%s' not supported, using ONNX Runtime\n", options.backend.c_str());
+        }
+        // Binding lama menunjuk session lama: lepas dulu sebelum session diganti
+        binding_ = Ort::IoBinding(nullptr);
+        ortOutputs_.clear();
+        boundBatch_ = 0;
+        session_ = createOrtSession(modelPath, options);
+
+        Ort::AllocatorWithDefaultOptions allocator;
+        inputName_ = session_.GetInputNameAllocated(0, allocator).get();
+        outputName_ = session_.GetOutputNameAllocated(0, allocator).get();
 
         // Auto-detect input size from model
         auto inputShape = session_.GetInputTypeInfo(0)
@@ -41,8 +48,35 @@ bool DepthAntiSpoofing::LoadModel(const std::string& modelPath, float flatThresh
         // inputShape: [1, 3, H, W]
         inputH_ = static_cast<int>(inputShape[2]);
         inputW_ = static_cast<int>(inputShape[3]);
+        batchDynamic_ = inputShape[0] < 0;
         flatThreshold_ = flatThreshold;
-        printf("[DepthAntiSpoofing] Input size: %dx%d. threshold : %.2f\n", inputW_, inputH_, flatThreshold);
+        // INTER_CUBIC dipertahankan (threshold stddev dikalibrasi dengan resize ini)
+        preprocessor_.configure(cv::Size(inputW_, inputH_), NormalizeParams::meanStd(mean_, std_), cv::INTER_CUBIC);
+
+        // outputShape: [N, H, W] (sebagian export [N, 1, H, W]). Bila H/W static,
+        // output dipreallocate dan di-bind; bila dinamis ORT yang mengalokasi.
+        outputShape_ = session_.GetOutputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+        outputH_ = outputW_ = 0;
+        bool outputStatic = outputShape_.size() >= 3 &&
+            std::all_of(outputShape_.begin() + 1, outputShape_.end(), [](int64_t d) { return d > 0; });
+        if (outputStatic) {
+            outputH_ = static_cast<int>(outputShape_[outputShape_.size() - 2]);
+            outputW_ = static_cast<int>(outputShape_.back());
+        }
+
+        memInfo_ = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+        binding_ = Ort::IoBinding(session_);
+        bindBatch(1);
+
+        printf("[DepthAntiSpoofing] Input size: %dx%d. threshold : %.2f, batch: %s, %s\n", inputW_, inputH_,
+               flatThreshold, batchDynamic_ ? "dynamic" : "1", options.describe().c_str());
+        if (outputStatic) {
+            printf("[DepthAntiSpoofing] I/O binding: %s -> %s (%dx%d, preallocated)\n",
+                   inputName_.c_str(), outputName_.c_str(), outputW_, outputH_);
+        } else {
+            printf("[DepthAntiSpoofing] I/O binding: %s -> %s (dynamic output, allocated by ORT)\n",
+                   inputName_.c_str(), outputName_.c_str());
+        }
         
         return true;
     }
@@ -52,13 +86,94 @@ bool DepthAntiSpoofing::LoadModel(const std::string& modelPath, float flatThresh
     }
 }
 
+void DepthAntiSpoofing::setInputMode(DepthInputMode mode, float roiPadding)
+{
+    inputMode_ = mode;
+    roiPadding_ = std::max(0.0f, roiPadding);
+    if (mode == DepthInputMode::Roi) {
+        printf("[DepthAntiSpoofing] Input mode: roi, padding %.2f\n", roiPadding_);
+    }
+}
+
+DepthRequest DepthAntiSpoofing::modelInput(const DepthRequest& request) const
+{
+    const cv::Mat& frame = request.frame;
+    const cv::Rect& faceRect = request.faceRect;
+    if (inputMode_ == DepthInputMode::Full || faceRect.empty()) {
+        return request;
+    }
+
+    // Crop persegi (input model persegi, aspect ratio wajah tidak terdistorsi),
+    // digeser masuk ke dalam frame bila wajah dekat tepi
+    int side = static_cast<int>(std::max(faceRect.width, faceRect.height) * (1.0f + roiPadding_));
+    side = std::min(side, std::min(frame.cols, frame.rows));
+    int cx = faceRect.x + faceRect.width / 2;
+    int cy = faceRect.y + faceRect.height / 2;
+    int x = std::min(std::max(0, cx - side / 2), frame.cols - side);
+    int y = std::min(std::max(0, cy - side / 2), frame.rows - side);
+    cv::Rect roi(x, y, side, side);
+
+    cv::Rect face = faceRect & roi;
+    if (face.empty()) {
+        return request;
+    }
+    face.x -= roi.x;
+    face.y -= roi.y;
+    return DepthRequest{frame(roi), face, request.debug};  // view, tanpa copy
+}
+
 bool DepthAntiSpoofing::isSpoof(const cv::Mat& frame, const cv::Rect& faceRect, float& stddevOut)
 {
-    cv::Mat depthMap = runInference(frame);
+    DepthRequest input = modelInput(DepthRequest{frame, faceRect, debugSink().sample()});
+    cv::Mat depthMap = runInference(input.frame);
+    return evaluate(input, depthMap, stddevOut);
+}
+
+std::vector<DepthCheck> DepthAntiSpoofing::isSpoofBatch(const std::vector<DepthRequest>& requests)
+{
+    std::vector<DepthCheck> results(requests.size());
+    if (!batchDynamic_ || requests.size() == 1) {
+        // Model static: Run per frame, depth map langsung dievaluasi sebelum
+        // buffer output ditimpa Run berikutnya
+        for (size_t i = 0; i < requests.size(); ++i) {
+            DepthRequest input = modelInput(requests[i]);
+            cv::Mat depthMap = runInference(input.frame);
+            results[i].spoof = evaluate(input, depthMap, results[i].stddev);
+        }
+        return results;
+    }
+
+    std::vector<DepthRequest> inputs;
+    std::vector<cv::Mat> frames;
+    inputs.reserve(requests.size());
+    frames.reserve(requests.size());
+    for (const auto& r : requests) {
+        inputs.push_back(modelInput(r));
+        frames.push_back(inputs.back().frame);
+    }
+
+    std::vector<cv::Mat> depthMaps = runInferenceBatch(frames);
+    for (size_t i = 0; i < requests.size(); ++i) {
+        results[i].spoof = evaluate(inputs[i], depthMaps[i], results[i].stddev);
+    }
+    return results;
+}
 
+float DepthAntiSpoofing::faceDepthStddev(const cv::Mat& frame, const cv::Rect& faceRect)
+{
+    DepthRequest input = modelInput(DepthRequest{frame, faceRect});
+    cv::Mat depthMap = runInference(input.frame);
+    float stddev = 0.0f;
+    measureFaceStddev(input.frame.size(), input.faceRect, depthMap, stddev);
+    return stddev;
+}
+
+bool DepthAntiSpoofing::measureFaceStddev(const cv::Size& frameSize, const cv::Rect& faceRect,
+                                          const cv::Mat& depthMap, float& stddevOut)
+{
     // Scale rect dari koordinat frame -> koordinat depth map
-    float scaleX = static_cast<float>(inputW_) / frame.cols;
-    float scaleY = static_cast<float>(inputH_) / frame.rows;
+    float scaleX = static_cast<float>(depthMap.cols) / frameSize.width;
+    float scaleY = static_cast<float>(depthMap.rows) / frameSize.height;
 
     cv::Rect scaledRect(
         static_cast<int>(faceRect.x * scaleX),
@@ -66,26 +181,41 @@ bool DepthAntiSpoofing::isSpoof(const cv::Mat& frame, const cv::Rect& faceRect,
         static_cast<int>(faceRect.width  * scaleX),
         static_cast<int>(faceRect.height * scaleY)
     );
-    scaledRect &= cv::Rect(0, 0, inputW_, inputH_);
+    scaledRect &= cv::Rect(0, 0, depthMap.cols, depthMap.rows);
 
     if (scaledRect.empty()) {
         stddevOut = 0.0f;
-        return true;
+        return false;
     }
 
     cv::Mat faceDepth = depthMap(scaledRect);
     stddevOut = getDepthStddev(faceDepth);
+    return true;
+}
 
-    // Debug imwrite
-    cv::Mat debugVis = postprocess(depthMap, cv::Size(frame.cols, frame.rows));
-    cv::rectangle(debugVis, faceRect, cv::Scalar(0, 255, 0), 2);
-    std::string label = (stddevOut < flatThreshold_ ? "SPOOF" : "REAL");
-    label += " std=" + std::to_string(stddevOut);
-    cv::putText(debugVis, label, cv::Point(faceRect.x, faceRect.y - 5),
-                cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(0, 255, 0), 2);
-    cv::imwrite("spoof_detect.jpg", debugVis);
+bool DepthAntiSpoofing::evaluate(const DepthRequest& input, const cv::Mat& depthMap, float& stddevOut)
+{
+    if (!measureFaceStddev(input.frame.size(), input.faceRect, depthMap, stddevOut)) {
+        return true;
+    }
+    bool spoof = stddevOut < flatThreshold_;
+
+    if (input.debug) {
+        // Colormap + resize dikerjakan thread writer. depthMap adalah view ke
+        // buffer output yang ditimpa Run berikutnya: clone hanya di jalur debug
+        cv::Size size = input.frame.size();
+        cv::Rect rect = input.faceRect;
+        std::string label = std::string(spoof ? "SPOOF" : "REAL") + " std=" + std::to_string(stddevOut);
+        debugSink().render("spoof_detect.jpg", [depthMap = depthMap.clone(), size, rect, label]() {
+            cv::Mat debugVis = postprocess(depthMap, size);
+            cv::rectangle(debugVis, rect, cv::Scalar(0, 255, 0), 2);
+            cv::putText(debugVis, label, cv::Point(rect.x, rect.y - 5),
+                        cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(0, 255, 0), 2);
+            return debugVis;
+        });
+    }
 
-    return stddevOut < flatThreshold_;
+    return spoof;
 }
 
 bool DepthAntiSpoofing::isSpoof(const cv::Mat& frame, const cv::Rect& faceRect)
@@ -117,56 +247,98 @@ cv::Mat DepthAntiSpoofing::getDepthMap(const cv::Mat& frame, const cv::Rect& fac
 
 std::vector<float> DepthAntiSpoofing::preprocess(const cv::Mat& frame)
 {
-    cv::Mat resized, rgb;
-    cv::resize(frame, resized, cv::Size(inputW_, inputH_), 0, 0, cv::INTER_CUBIC);
-    cv::cvtColor(resized, rgb, cv::COLOR_BGR2RGB);
-
     std::vector<float> blob(1 * 3 * inputH_ * inputW_);
-    int planeSize = inputH_ * inputW_;
-
-    for (int y = 0; y < inputH_; ++y) {
-        for (int x = 0; x < inputW_; ++x) {
-            cv::Vec3b pixel = rgb.at<cv::Vec3b>(y, x);
-            int idx = y * inputW_ + x;
-            blob[0 * planeSize + idx] = (pixel[0] / 255.0f - mean_[0]) / std_[0];
-            blob[1 * planeSize + idx] = (pixel[1] / 255.0f - mean_[1]) / std_[1];
-            blob[2 * planeSize + idx] = (pixel[2] / 255.0f - mean_[2]) / std_[2];
-        }
-    }
+    preprocessInto(frame, blob.data());
     return blob;
 }
 
-cv::Mat DepthAntiSpoofing::runInference(const cv::Mat& frame)
+void DepthAntiSpoofing::preprocessInto(const cv::Mat& frame, float* blob)
 {
-    std::vector<float> inputData = preprocess(frame);
-    std::vector<int64_t> inputShape = {1, 3, inputH_, inputW_};
-
-    Ort::MemoryInfo memInfo = Ort::MemoryInfo::CreateCpu(
-        OrtArenaAllocator, OrtMemTypeDefault);
+    preprocessor_.run(frame, blob);
+}
 
-    Ort::Value inputTensor = Ort::Value::CreateTensor<float>(
-        memInfo,
-        inputData.data(),
-        inputData.size(),
+void DepthAntiSpoofing::bindBatch(size_t batch)
+{
+    if (batch == boundBatch_) return;
+
+    // Tensor hanya membungkus buffer milik sendiri (tanpa copy); buffer hanya
+    // tumbuh, jadi bind ulang cukup saat ukuran batch berubah
+    const size_t inputCount = batch * preprocessor_.tensorSize();
+    std::vector<int64_t> inputShape = {static_cast<int64_t>(batch), 3, inputH_, inputW_};
+    inputTensor_ = Ort::Value::CreateTensor<float>(
+        memInfo_,
+        inputBuffer_.reserve(inputCount),
+        inputCount,
         inputShape.data(),
         inputShape.size()
     );
+    binding_.ClearBoundInputs();
+    binding_.BindInput(inputName_.c_str(), inputTensor_);
+
+    binding_.ClearBoundOutputs();
+    if (outputH_ > 0) {
+        outputShape_[0] = static_cast<int64_t>(batch);
+        size_t outputCount = 1;
+        for (int64_t d : outputShape_) outputCount *= static_cast<size_t>(d);
+        outputTensor_ = Ort::Value::CreateTensor<float>(
+            memInfo_,
+            outputBuffer_.reserve(outputCount),
+            outputCount,
+            outputShape_.data(),
+            outputShape_.size()
+        );
+        binding_.BindOutput(outputName_.c_str(), outputTensor_);
+    } else {
+        binding_.BindOutput(outputName_.c_str(), memInfo_);
+    }
+    boundBatch_ = batch;
+}
 
-    const char* inputNames[]  = {"input"};
-    const char* outputNames[] = {"depth"};
+float* DepthAntiSpoofing::runBound(int& outH, int& outW)
+{
+    session_.Run(Ort::RunOptions{nullptr}, binding_);
+    if (outputH_ > 0) {
+        outH = outputH_;
+        outW = outputW_;
+        return outputBuffer_.data();
+    }
 
-    auto outputTensors = session_.Run(
-        Ort::RunOptions{nullptr},
-        inputNames, &inputTensor, 1,
-        outputNames, 1
-    );
+    ortOutputs_ = binding_.GetOutputValues();
+    auto outputShape = ortOutputs_[0].GetTensorTypeAndShapeInfo().GetShape();
+    outH = static_cast<int>(outputShape[outputShape.size() - 2]);
+    outW = static_cast<int>(outputShape.back());
+    return ortOutputs_[0].GetTensorMutableData<float>();
+}
 
-    float* outputData = outputTensors[0].GetTensorMutableData<float>();
-    auto outputShape  = outputTensors[0].GetTensorTypeAndShapeInfo().GetShape();
-    int outH = static_cast<int>(outputShape[1]);
-    int outW = static_cast<int>(outputShape[2]);
+cv::Mat DepthAntiSpoofing::runInference(const cv::Mat& frame)
+{
+    bindBatch(1);
+    preprocessInto(frame, inputBuffer_.data());
+
+    int outH = 0, outW = 0;
+    float* outputData = runBound(outH, outW);
+    return cv::Mat(outH, outW, CV_32F, outputData);
+}
 
-    return cv::Mat(outH, outW, CV_32F, outputData).clone();
+std::vector<cv::Mat> DepthAntiSpoofing::runInferenceBatch(const std::vector<cv::Mat>& frames)
+{
+    // Hanya untuk model batch dinamis (lihat isSpoofBatch)
+    bindBatch(frames.size());
+    const size_t planeSize = preprocessor_.tensorSize();
+    float* inputData = inputBuffer_.data();
+    for (size_t i = 0; i < frames.size(); ++i) {
+        preprocessInto(frames[i], inputData + i * planeSize);
+    }
+
+    int outH = 0, outW = 0;
+    float* outputData = runBound(outH, outW);
+    const size_t outPlane = static_cast<size_t>(outH) * outW;
+    std::vector<cv::Mat> depthMaps;
+    depthMaps.reserve(frames.size());
+    for (size_t i = 0; i < frames.size(); ++i) {
+        depthMaps.push_back(cv::Mat(outH, outW, CV_32F, outputData + i * outPlane));
+    }
+    return depthMaps;
 }
 
 float DepthAntiSpoofing::getDepthStddev(const cv::Mat& depthMap)
@@ -6,30 +6,97 @@
 #include <vector>
 #include <string>
 
+#include "inference/ort_session.hpp"
+#include "inference/preprocess.hpp"
+
+struct DepthRequest
+{
+    cv::Mat frame;
+    cv::Rect faceRect;
+    bool debug = false;  // simpan visualisasi depth lewat debugSink()
+};
+
+struct DepthCheck
+{
+    bool spoof = true;
+    float stddev = 0.0f;
+};
+
+// Full: seluruh frame di-resize ke input model (wajah hanya sebagian kecil depth map)
+// Roi:  crop persegi di sekitar wajah (+ padding) yang di-resize ke input model
+enum class DepthInputMode { Full, Roi };
+
+DepthInputMode parseDepthInputMode(const std::string& mode);
+
 class DepthAntiSpoofing
 {
 public:
     DepthAntiSpoofing(float flatThreshold = 0.02f);
     DepthAntiSpoofing(const std::string& modelPath, float flatThreshold = 0.02f);
 
-    bool LoadModel(const std::string& modelPath, float flatThreshold = 0.02f);
+    bool LoadModel(const std::string& modelPath, float flatThreshold = 0.02f,
+                   const InferenceOptions& options = InferenceOptions());
 
     bool isSpoof(const cv::Mat& frame, const cv::Rect& faceRect, float& stddevOut);
     bool isSpoof(const cv::Mat& frame, const cv::Rect& faceRect);
 
+    // Model dengan batch dinamis: satu Run untuk semua frame.
+    // Model static (batch 1): Run per frame, hasil sama.
+    std::vector<DepthCheck> isSpoofBatch(const std::vector<DepthRequest>& requests);
+    bool supportsBatch() const { return batchDynamic_; }
+
+    // roiPadding: tambahan sisi crop relatif terhadap sisi wajah terpanjang (0.5 = 1.5x)
+    void setInputMode(DepthInputMode mode, float roiPadding = 0.5f);
+    DepthInputMode inputMode() const { return inputMode_; }
+
     cv::Mat getDepthMap(const cv::Mat& frame, const cv::Rect& faceRect, cv::Size targetSize = cv::Size());
 
+    // Untuk tool kalibrasi / perbandingan model: tanpa debug output
+    float faceDepthStddev(const cv::Mat& frame, const cv::Rect& faceRect);
+    // Tensor input sesuai inputMode (full frame atau ROI), sama dengan jalur server
+    std::vector<float> inputTensor(const cv::Mat& frame, const cv::Rect& faceRect)
+    {
+        return preprocess(modelInput(DepthRequest{frame, faceRect}).frame);
+    }
+    cv::Size inputSize() const { return cv::Size(inputW_, inputH_); }
+
 private:
     float flatThreshold_;
     int inputH_, inputW_;  // auto-detect dari model
-    Ort::Env env_;
+    bool batchDynamic_ = false;  // dimensi batch input = -1
+    DepthInputMode inputMode_ = DepthInputMode::Full;
+    float roiPadding_ = 0.5f;
     Ort::Session session_;
 
     const float mean_[3] = {0.485f, 0.456f, 0.406f};
     const float std_[3]  = {0.229f, 0.224f, 0.225f};
+    ImagePreprocessor preprocessor_;
+
+    // IoBinding persisten: input/output di-bind sekali ke buffer milik sendiri,
+    // di-bind ulang hanya bila ukuran batch berubah. Urutan deklarasi penting:
+    // binding/tensor harus dihancurkan sebelum buffer yang mereka tunjuk.
+    std::string inputName_, outputName_;  // dari model, bukan hardcode
+    std::vector<int64_t> outputShape_;    // [N, H, W]; dim batch diisi saat bind
+    int outputH_ = 0, outputW_ = 0;       // 0 = dimensi output dinamis, output dialokasi ORT
+    size_t boundBatch_ = 0;
+    TensorBuffer inputBuffer_;   // input NCHW
+    TensorBuffer outputBuffer_;  // depth N x H x W
+    Ort::MemoryInfo memInfo_{nullptr};
+    Ort::Value inputTensor_{nullptr};
+    Ort::Value outputTensor_{nullptr};
+    Ort::IoBinding binding_{nullptr};
+    std::vector<Ort::Value> ortOutputs_;  // hanya untuk output dinamis
 
+    DepthRequest modelInput(const DepthRequest& request) const;
     std::vector<float> preprocess(const cv::Mat& frame);
+    void preprocessInto(const cv::Mat& frame, float* blob);
+    void bindBatch(size_t batch);
+    float* runBound(int& outH, int& outW);
+    // Hasil berupa view ke buffer output yang di-bind: valid sampai Run berikutnya
     cv::Mat runInference(const cv::Mat& frame);
-    cv::Mat postprocess(const cv::Mat& depthMap, cv::Size targetSize);
+    std::vector<cv::Mat> runInferenceBatch(const std::vector<cv::Mat>& frames);
+    bool measureFaceStddev(const cv::Size& frameSize, const cv::Rect& faceRect, const cv::Mat& depthMap, float& stddevOut);
+    bool evaluate(const DepthRequest& input, const cv::Mat& depthMap, float& stddevOut);
+    static cv::Mat postprocess(const cv::Mat& depthMap, cv::Size targetSize);
     float getDepthStddev(const cv::Mat& depthMap);
 };
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include "temporal_liveness.hpp"
+#include "config/load_config.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+LivenessParams LivenessParams::fromConfig(const Config& cfg, float flatThreshold)
+{
+    LivenessParams p;
+    p.flatThreshold = flatThreshold;
+    p.window = std::max(1, cfg.getInt("liveness_window", p.window));
+    p.depthEvery = std::max(1, cfg.getInt("liveness_depth_every", p.depthEvery));
+    p.minDepthSamples = std::max(1, cfg.getInt("liveness_min_depth_samples", p.minDepthSamples));
+    p.margin = std::max(0.0f, cfg.getFloat("liveness_margin", p.margin));
+    p.maxDepthSpread = cfg.getFloat("liveness_max_depth_spread", p.maxDepthSpread);
+    p.minMotion = cfg.getFloat("liveness_min_motion", p.minMotion);
+    p.blinkRatio = cfg.getFloat("liveness_blink_ratio", p.blinkRatio);
+    return p;
+}
+
+TemporalLiveness::TemporalLiveness(const LivenessParams& params)
+:   params_(params)
+{
+    depth_.reserve(params_.window);
+}
+
+void TemporalLiveness::reset()
+{
+    frames_ = 0;
+    depth_.clear();
+    motionSum_ = 0.0f;
+    motionCount_ = 0;
+    blinked_ = false;
+    mouthMoved_ = false;
+    prevFace_.release();
+    prevEyes_.release();
+    prevMouth_.release();
+}
+
+// Patch abu-abu ukuran tetap, dinormalisasi ke mean 0 / std 1
+bool TemporalLiveness::normalizedPatch(const cv::Mat& frame, const cv::Rect& roi, cv::Size size, cv::Mat& out)
+{
+    cv::Rect r = roi & cv::Rect(0, 0, frame.cols, frame.rows);
+    if (r.width < 4 || r.height < 4) return false;
+
+    cv::resize(frame(r), patch_, size, 0, 0, cv::INTER_AREA);
+    if (patch_.channels() == 3) {
+        cv::cvtColor(patch_, gray_, cv::COLOR_BGR2GRAY);
+    } else {
+        gray_ = patch_;
+    }
+    cv::Scalar mean, stddev;
+    cv::meanStdDev(gray_, mean, stddev);
+    double scale = 1.0 / std::max(stddev[0], 1.0);
+    gray_.convertTo(out, CV_32F, scale, -mean[0] * scale);
+    return true;
+}
+
+// Patch 16x16 di sekitar tiap titik, disusun berdampingan di out
+bool TemporalLiveness::landmarkPatches(const cv::Mat& frame, const cv::Point2f* points, int count, int side,
+                                       cv::Mat& out)
+{
+    out.create(16, 16 * count, CV_32F);
+    for (int i = 0; i < count; ++i) {
+        cv::Rect roi(static_cast<int>(points[i].x) - side / 2, static_cast<int>(points[i].y) - side / 2,
+                     side, side);
+        cv::Mat cell = out(cv::Rect(i * 16, 0, 16, 16));
+        if (!normalizedPatch(frame, roi, cv::Size(16, 16), cell)) return false;
+    }
+    return true;
+}
+
+// Gerak lokal dihitung hanya bila jauh melebihi gerak seluruh wajah: gerak rigid
+// (jitter box, foto/layar yang digoyang) dan noise menggeser patch secara merata
+bool TemporalLiveness::localCue(const cv::Mat& current, cv::Mat& previous, float faceMotion)
+{
+    bool cue = false;
+    if (!previous.empty() && faceMotion >= 0.0f) {
+        cv::absdiff(current, previous, diff_);
+        float motion = static_cast<float>(cv::mean(diff_)[0]);
+        cue = motion > params_.minMotion && motion > params_.blinkRatio * faceMotion;
+    }
+    current.copyTo(previous);
+    return cue;
+}
+
+void TemporalLiveness::observe(const cv::Mat& frame, const cv::Rect& face, const std::vector<cv::Point2f>& landmarks)
+{
+    ++frames_;
+
+    cv::Mat facePatch;
+    if (!normalizedPatch(frame, face, cv::Size(48, 48), facePatch)) return;
+    float faceMotion = -1.0f;
+    if (!prevFace_.empty()) {
+        cv::absdiff(facePatch, prevFace_, diff_);
+        faceMotion = static_cast<float>(cv::mean(diff_)[0]);
+        motionSum_ += faceMotion;
+        ++motionCount_;
+    }
+    prevFace_ = facePatch;
+
+    // YuNet: 0-1 mata, 2 hidung, 3-4 sudut mulut; tanpa landmark (Haar) tidak ada cue lokal
+    int side = std::max(4, face.width / 4);
+    cv::Mat patches;
+    if (landmarks.size() >= 2) {
+        if (landmarkPatches(frame, &landmarks[0], 2, side, patches)) {
+            if (localCue(patches, prevEyes_, faceMotion)) blinked_ = true;
+        } else {
+            prevEyes_.release();
+        }
+    }
+    if (landmarks.size() >= 5) {
+        if (landmarkPatches(frame, &landmarks[3], 2, side, patches)) {
+            if (localCue(patches, prevMouth_, faceMotion)) mouthMoved_ = true;
+        } else {
+            prevMouth_.release();
+        }
+    }
+}
+
+bool TemporalLiveness::wantsDepth() const
+{
+    // observe() sudah menaikkan frames_: frame pertama track = indeks 0
+    return frames_ > 0 && (frames_ - 1) % params_.depthEvery == 0;
+}
+
+void TemporalLiveness::addDepth(float stddev)
+{
+    depth_.push_back(stddev);
+}
+
+float TemporalLiveness::depthScore() const
+{
+    if (depth_.empty()) return 0.0f;
+    std::vector<float> sorted(depth_);
+    std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+    return sorted[sorted.size() / 2];
+}
+
+float TemporalLiveness::motionScore() const
+{
+    return motionCount_ > 0 ? motionSum_ / motionCount_ : 0.0f;
+}
+
+bool TemporalLiveness::hasMotionCue() const
+{
+    return blinked_ || mouthMoved_;
+}
+
+LivenessDecision TemporalLiveness::decision() const
+{
+    if (static_cast<int>(depth_.size()) < params_.minDepthSamples) {
+        // Jendela habis sebelum sampel cukup (depthEvery terlalu besar): putuskan dengan yang ada
+        if (depth_.empty() || frames_ < params_.window) return LivenessDecision::Pending;
+    }
+
+    // Satu sampel saja di bawah threshold sudah spoof: frame itu juga ditolak oleh
+    // mode single-frame, jadi median tidak boleh menutupinya
+    auto range = std::minmax_element(depth_.begin(), depth_.end());
+    if (*range.first < params_.flatThreshold) return LivenessDecision::Spoof;
+    const float median = depthScore();
+    const float high = params_.flatThreshold * (1.0f + params_.margin);
+
+    float spread = (*range.second - *range.first) / std::max(median, 1e-6f);
+    bool consistent = spread <= params_.maxDepthSpread;
+    if (median >= high && consistent) return LivenessDecision::Live;
+
+    // Pita ragu atau depth tidak konsisten: butuh kedip / gerak mulut
+    if (hasMotionCue()) return LivenessDecision::Live;
+    return frames_ >= params_.window ? LivenessDecision::Spoof : LivenessDecision::Pending;
+}
+
+std::string TemporalLiveness::describe() const
+{
+    char buf[128];
+    std::snprintf(buf, sizeof(buf), "frames=%d depth=%d median=%.3f motion=%.3f blink=%d mouth=%d",
+                  frames_, depthSamples(), depthScore(), motionScore(), blinked_ ? 1 : 0, mouthMoved_ ? 1 : 0);
+    return buf;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+class Config;
+
+struct LivenessParams
+{
+    float flatThreshold = 0.5f;   // sama dengan spoof_threshold / spoof_threshold_roi
+    int window = 15;              // frame maksimum per keputusan
+    int depthEvery = 3;           // depth hanya tiap N frame (frame 0, N, 2N, ...)
+    int minDepthSamples = 3;
+    float margin = 0.2f;          // pita ragu: [threshold, threshold * (1 + margin))
+    float maxDepthSpread = 0.5f;  // (max - min) / median stddev antar sampel depth
+    float minMotion = 0.08f;      // gerak minimum area mata / mulut untuk dihitung sebagai cue
+    float blinkRatio = 2.5f;      // gerak area mata / mulut dibanding gerak seluruh wajah
+
+    static LivenessParams fromConfig(const Config& cfg, float flatThreshold);
+};
+
+enum class LivenessDecision { Pending, Live, Spoof };
+
+// Keputusan liveness atas jendela beberapa frame dari satu track wajah.
+//   - depth: stddev depth wajah hanya pada frame yang diminta (wantsDepth),
+//     diagregasi median + dicek konsistensinya (spread antar sampel)
+//   - gerak wajah: selisih patch wajah abu-abu 48x48 (ter-normalisasi mean/std)
+//     antar frame; jitter box, goyangan tangan dan noise sensor ikut terukur di sini
+//   - cue lokal: selisih patch sekitar landmark mata (kedip) dan sudut mulut
+//     (ekspresi), dihitung hanya bila jauh di atas gerak seluruh wajah
+// Satu sampel depth di bawah threshold sudah spoof (tidak pernah lebih longgar dari
+// mode single-frame); median di atas pita ragu dan konsisten langsung hidup. Di dalam pita (atau depth tidak
+// konsisten) wajah dianggap hidup hanya dengan cue lokal, bukan gerak patch mentah.
+// Tidak thread-safe: satu instance per sesi stream.
+class TemporalLiveness
+{
+public:
+    explicit TemporalLiveness(const LivenessParams& params = LivenessParams());
+
+    void reset();
+    // Cue murah, dipanggil tiap frame sebelum wantsDepth()
+    void observe(const cv::Mat& frame, const cv::Rect& face, const std::vector<cv::Point2f>& landmarks);
+    bool wantsDepth() const;
+    void addDepth(float stddev);
+    LivenessDecision decision() const;
+
+    float depthScore() const;     // median stddev depth (0 bila belum ada sampel)
+    float motionScore() const;    // rata-rata gerak patch wajah (informasi, bukan cue)
+    bool blinked() const { return blinked_; }
+    bool mouthMoved() const { return mouthMoved_; }
+    int frames() const { return frames_; }
+    int depthSamples() const { return static_cast<int>(depth_.size()); }
+    std::string describe() const;
+
+private:
+    LivenessParams params_;
+    int frames_ = 0;
+    std::vector<float> depth_;
+    float motionSum_ = 0.0f;
+    int motionCount_ = 0;
+    bool blinked_ = false;
+    bool mouthMoved_ = false;
+    cv::Mat prevFace_, prevEyes_, prevMouth_;
+    cv::Mat gray_, patch_, diff_;  // buffer kerja, dipakai ulang antar frame
+
+    bool normalizedPatch(const cv::Mat& frame, const cv::Rect& roi, cv::Size size, cv::Mat& out);
+    bool landmarkPatches(const cv::Mat& frame, const cv::Point2f* points, int count, int side, cv::Mat& out);
+    bool localCue(const cv::Mat& current, cv::Mat& previous, float faceMotion);
+    bool hasMotionCue() const;
+};
@@ -1,50 +1,218 @@
 #include "base64.hpp"
-#include <cctype>
-#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
 
-static const std::string base64_chars = 
-    "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-    "abcdefghijklmnopqrstuvwxyz"
-    "0123456789+/";
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BASE64_X86 1
+#endif
 
-static inline bool is_base64(unsigned char c) {
-    return (isalnum(c) || (c == '+') || (c == '/'));
+namespace {
+
+const uint8_t kInvalid = 0xff;
+const uint8_t kSpace = 0xfe;
+// Slack di akhir output: kernel SIMD menyimpan 16/32 byte untuk 12/24 byte hasil
+const size_t kOutSlack = 32;
+
+struct Table {
+    uint8_t v[256];
+    Table() {
+        std::memset(v, kInvalid, sizeof(v));
+        const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        for (int i = 0; i < 64; ++i) v[static_cast<uint8_t>(alphabet[i])] = static_cast<uint8_t>(i);
+        v[' '] = v['\t'] = v['\r'] = v['\n'] = kSpace;
+    }
+};
+
+const Table kTable;
+
+// Blok 4*k karakter valid -> 3*k byte. Return jumlah karakter yang diproses;
+// berhenti di blok pertama yang berisi karakter di luar alfabet.
+typedef size_t (*BlockFn)(const uint8_t* src, size_t len, uint8_t* dst);
+
+size_t blocksNone(const uint8_t*, size_t, uint8_t*) {
+    return 0;
 }
 
-std::vector<unsigned char> Base64::decode(const std::string& encoded_string) {
-    int in_len = encoded_string.size();
-    int i = 0;
-    int j = 0;
-    int in_ = 0;
-    unsigned char char_array_4[4], char_array_3[3];
-    std::vector<unsigned char> ret;
+#ifdef BASE64_X86
+// Validasi + translasi ASCII -> 6 bit dengan pshufb per nibble (metode Muła),
+// lalu pack 4x6 bit -> 3 byte dengan maddubs / madd.
+__attribute__((target("ssse3")))
+size_t blocksSsse3(const uint8_t* src, size_t len, uint8_t* dst) {
+    const __m128i shiftLut = _mm_setr_epi8(0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i maskLut = _mm_setr_epi8(
+        (char)0xa8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8,
+        (char)0xf8, (char)0xf8, (char)0xf0, 0x54, 0x50, 0x50, 0x50, 0x54);
+    const __m128i bitLut = _mm_setr_epi8(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80,
+                                         0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    const __m128i slash = _mm_set1_epi8('/');
+    const __m128i packShuffle = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
 
-    while (in_len-- && (encoded_string[in_] != '=') && is_base64(encoded_string[in_])) {
-        char_array_4[i++] = encoded_string[in_]; in_++;
-        if (i == 4) {
-            for (i = 0; i < 4; i++)
-                char_array_4[i] = base64_chars.find(char_array_4[i]);
-            char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-            char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-            char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
-
-            for (i = 0; i < 3; i++)
-                ret.push_back(char_array_3[i]);
-            i = 0;
-        }
+    size_t done = 0;
+    for (; done + 16 <= len; done += 16) {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + done));
+        __m128i hi = _mm_and_si128(_mm_srli_epi32(in, 4), nibble);
+        __m128i lo = _mm_and_si128(in, nibble);
+        __m128i valid = _mm_and_si128(_mm_shuffle_epi8(maskLut, lo), _mm_shuffle_epi8(bitLut, hi));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(valid, _mm_setzero_si128()))) break;
+
+        __m128i isSlash = _mm_cmpeq_epi8(in, slash);
+        __m128i shift = _mm_shuffle_epi8(shiftLut, hi);
+        shift = _mm_or_si128(_mm_andnot_si128(isSlash, shift), _mm_and_si128(isSlash, _mm_set1_epi8(16)));
+        __m128i values = _mm_add_epi8(in, shift);
+
+        __m128i merged = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+        __m128i packed = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_shuffle_epi8(packed, packShuffle));
+        dst += 12;
     }
+    return done;
+}
+
+__attribute__((target("avx2")))
+size_t blocksAvx2(const uint8_t* src, size_t len, uint8_t* dst) {
+    const __m256i shiftLut = _mm256_setr_epi8(
+        0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i maskLut = _mm256_setr_epi8(
+        (char)0xa8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8,
+        (char)0xf8, (char)0xf8, (char)0xf0, 0x54, 0x50, 0x50, 0x50, 0x54,
+        (char)0xa8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8,
+        (char)0xf8, (char)0xf8, (char)0xf0, 0x54, 0x50, 0x50, 0x50, 0x54);
+    const __m256i bitLut = _mm256_setr_epi8(
+        0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80, 0, 0, 0, 0, 0, 0, 0, 0,
+        0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    const __m256i slash = _mm256_set1_epi8('/');
+    const __m256i packShuffle = _mm256_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    const __m256i lanePermute = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+
+    size_t done = 0;
+    for (; done + 32 <= len; done += 32) {
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + done));
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi32(in, 4), nibble);
+        __m256i lo = _mm256_and_si256(in, nibble);
+        __m256i valid = _mm256_and_si256(_mm256_shuffle_epi8(maskLut, lo), _mm256_shuffle_epi8(bitLut, hi));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(valid, _mm256_setzero_si256()))) break;
 
-    if (i) {
-        for (j = i; j < 4; j++)
-            char_array_4[j] = 0;
-        for (j = 0; j < 4; j++)
-            char_array_4[j] = base64_chars.find(char_array_4[j]);
-        char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-        char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-        char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
+        __m256i shift = _mm256_blendv_epi8(_mm256_shuffle_epi8(shiftLut, hi), _mm256_set1_epi8(16),
+                                           _mm256_cmpeq_epi8(in, slash));
+        __m256i values = _mm256_add_epi8(in, shift);
 
-        for (j = 0; j < i - 1; j++) ret.push_back(char_array_3[j]);
+        __m256i merged = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+        __m256i packed = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+        packed = _mm256_shuffle_epi8(packed, packShuffle);
+        packed = _mm256_permutevar8x32_epi32(packed, lanePermute);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), packed);
+        dst += 24;
     }
+    return done;
+}
+#endif
+
+struct Dispatch {
+    BlockFn blocks;
+    const char* name;
+};
+
+Dispatch resolve() {
+    Dispatch d{blocksNone, "scalar"};
+#ifdef BASE64_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("ssse3")) d = {blocksSsse3, "ssse3"};
+    if (__builtin_cpu_supports("avx2")) d = {blocksAvx2, "avx2"};
+#endif
+    return d;
+}
+
+const Dispatch& dispatch() {
+    static const Dispatch d = resolve();
+    return d;
+}
+
+// Lewati "data:<mime>;base64," di awal input
+size_t skipDataUrl(const char* data, size_t len) {
+    if (len < 5 || std::memcmp(data, "data:", 5) != 0) return 0;
+    const void* comma = std::memchr(data, ',', len);
+    return comma ? static_cast<size_t>(static_cast<const char*>(comma) - data) + 1 : 0;
+}
 
+} // namespace
+
+bool Base64::decodeInto(const char* data, size_t len, std::vector<unsigned char>& out) {
+    size_t pos = skipDataUrl(data, len);
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(data);
+
+    out.resize((len - pos) / 4 * 3 + 3 + kOutSlack);
+    uint8_t* dst = out.data();
+    const BlockFn blocks = dispatch().blocks;
+
+    uint32_t acc = 0;
+    int n = 0;  // sextet di acc
+    while (pos < len) {
+        // Kernel SIMD hanya di batas kuantum (acc kosong); berhenti di whitespace / '='
+        if (n == 0 && len - pos >= 32) {
+            size_t consumed = blocks(src + pos, len - pos, dst);
+            pos += consumed;
+            dst += consumed / 4 * 3;
+            if (pos >= len) break;
+        }
+
+        uint8_t c = src[pos];
+        uint8_t v = kTable.v[c];
+        if (v < 64) {
+            acc = (acc << 6) | v;
+            if (++n == 4) {
+                dst[0] = static_cast<uint8_t>(acc >> 16);
+                dst[1] = static_cast<uint8_t>(acc >> 8);
+                dst[2] = static_cast<uint8_t>(acc);
+                dst += 3;
+                acc = 0;
+                n = 0;
+            }
+        } else if (c == '=') {
+            break;
+        } else if (v != kSpace) {
+            out.clear();
+            return false;
+        }
+        ++pos;
+    }
+
+    // Padding: sisa 2 sextet -> 1 byte, 3 sextet -> 2 byte; setelah '=' hanya '=' / whitespace
+    for (size_t i = pos; i < len; ++i) {
+        if (src[i] != '=' && kTable.v[src[i]] != kSpace) {
+            out.clear();
+            return false;
+        }
+    }
+    if (n == 1) {
+        out.clear();
+        return false;
+    }
+    if (n == 2) {
+        *dst++ = static_cast<uint8_t>(acc >> 4);
+    } else if (n == 3) {
+        *dst++ = static_cast<uint8_t>(acc >> 10);
+        *dst++ = static_cast<uint8_t>(acc >> 2);
+    }
+
+    out.resize(static_cast<size_t>(dst - out.data()));
+    return true;
+}
+
+std::vector<unsigned char> Base64::decode(const std::string& encoded_string) {
+    std::vector<unsigned char> ret;
+    if (!decodeInto(encoded_string, ret)) {
+        throw std::runtime_error("Invalid base64 image");
+    }
     return ret;
-}
\ No newline at end of file
+}
+
+const char* Base64::implementation() {
+    return dispatch().name;
+}
@@ -1,12 +1,27 @@
 #ifndef BASE64_HPP
 #define BASE64_HPP
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
+// Decoder base64 standar (RFC 4648, alfabet +/). Menerima prefix data URL
+// ("data:image/jpeg;base64,...") dan whitespace / baris baru di tengah input.
+// Blok tanpa whitespace di-decode dengan AVX2 / SSSE3 (dipilih saat runtime),
+// sisanya dengan lookup table.
 class Base64 {
 public:
+    // Throw std::runtime_error bila input bukan base64 valid
     static std::vector<unsigned char> decode(const std::string& encoded_string);
+
+    // Decode ke buffer milik pemanggil; kapasitas out dipakai ulang antar
+    // panggilan, out.size() = jumlah byte hasil. false bila input tidak valid.
+    static bool decodeInto(const char* data, size_t len, std::vector<unsigned char>& out);
+    static bool decodeInto(const std::string& encoded, std::vector<unsigned char>& out) {
+        return decodeInto(encoded.data(), encoded.size(), out);
+    }
+
+    static const char* implementation();
 };
 
-#endif
\ No newline at end of file
+#endif
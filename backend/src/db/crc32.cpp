@@ -0,0 +1,29 @@
+#include "crc32.hpp"
+
+namespace {
+
+struct Crc32cTable {
+    uint32_t t[256];
+    Crc32cTable() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? (c >> 1) ^ 0x82f63b78u : (c >> 1);
+            t[i] = c;
+        }
+    }
+};
+
+const Crc32cTable& table() {
+    static const Crc32cTable tbl;
+    return tbl;
+}
+
+} // namespace
+
+uint32_t crc32c(const void* data, size_t len, uint32_t crc) {
+    const uint32_t* t = table().t;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < len; ++i) crc = t[(crc ^ p[i]) & 0xffu] ^ (crc >> 8);
+    return ~crc;
+}
@@ -0,0 +1,10 @@
+#ifndef CRC32_HPP
+#define CRC32_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// CRC-32C (Castagnoli), dipakai untuk header file database dan record log
+uint32_t crc32c(const void* data, size_t len, uint32_t crc = 0);
+
+#endif
@@ -0,0 +1,54 @@
+#include "embedding_matrix.hpp"
+#include <cstring>
+#include <stdexcept>
+
+void EmbeddingMatrix::reset(size_t dim) {
+    dim_ = dim;
+    stride_ = strideFor(dim);
+    rows_ = 0;
+    data_.clear();
+    base_ = data_.data();
+    external_ = false;
+}
+
+void EmbeddingMatrix::reserve(size_t rows) {
+    if (external_) return;
+    data_.reserve(rows * stride_);
+    base_ = data_.data();
+}
+
+void EmbeddingMatrix::clear() {
+    rows_ = 0;
+    data_.clear();
+    base_ = external_ ? nullptr : data_.data();
+    external_ = false;
+}
+
+void EmbeddingMatrix::attach(const float* base, size_t dim, size_t stride, size_t rows) {
+    data_.clear();
+    data_.shrink_to_fit();
+    base_ = base;
+    dim_ = dim;
+    stride_ = stride;
+    rows_ = rows;
+    external_ = true;
+}
+
+size_t EmbeddingMatrix::append(const float* vec) {
+    if (external_) {
+        throw std::logic_error("EmbeddingMatrix: append on external view");
+    }
+    // Padding diisi 0 supaya kernel boleh membaca satu stride penuh
+    data_.resize((rows_ + 1) * stride_, 0.0f);
+    base_ = data_.data();
+    float* dst = data_.data() + rows_ * stride_;
+    std::memcpy(dst, vec, dim_ * sizeof(float));
+    return rows_++;
+}
+
+void EmbeddingMatrix::set(size_t i, const float* vec) {
+    if (external_ || i >= rows_) {
+        throw std::logic_error("EmbeddingMatrix: set on external view or invalid row");
+    }
+    std::memcpy(data_.data() + i * stride_, vec, dim_ * sizeof(float));
+}
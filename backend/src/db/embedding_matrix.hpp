@@ -0,0 +1,50 @@
+#ifndef EMBEDDING_MATRIX_HPP
+#define EMBEDDING_MATRIX_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "util/aligned_allocator.hpp"
+
+// Semua embedding dalam satu blok row-major. Tiap row di-pad ke kelipatan
+// 16 float sehingga setiap row mulai di batas 64 byte. Blok bisa dimiliki
+// sendiri (heap) atau berupa view ke memori luar, mis. file yang di-mmap.
+class EmbeddingMatrix {
+public:
+    static constexpr size_t kRowAlign = 16;
+
+    static size_t strideFor(size_t dim) { return (dim + kRowAlign - 1) / kRowAlign * kRowAlign; }
+
+    EmbeddingMatrix() = default;
+
+    void reset(size_t dim);
+    void reserve(size_t rows);
+    void clear();
+
+    // View tanpa copy; pemilik memori bertanggung jawab menjaga base tetap valid
+    void attach(const float* base, size_t dim, size_t stride, size_t rows);
+    bool external() const { return external_; }
+
+    // Menyalin vector ke row baru, return index row (hanya mode heap)
+    size_t append(const float* vec);
+    // Menimpa row yang sudah ada (hanya mode heap)
+    void set(size_t i, const float* vec);
+
+    const float* row(size_t i) const { return base_ + i * stride_; }
+    const float* data() const { return base_; }
+
+    size_t rows() const { return rows_; }
+    size_t dim() const { return dim_; }
+    size_t stride() const { return stride_; }
+    bool empty() const { return rows_ == 0; }
+
+private:
+    std::vector<float, AlignedAllocator<float>> data_;
+    const float* base_ = nullptr;
+    bool external_ = false;
+    size_t rows_ = 0;
+    size_t dim_ = 0;
+    size_t stride_ = 0;
+};
+
+#endif
@@ -3,17 +3,64 @@
 #include <sstream>
 #include <iomanip>
 #include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <chrono>
+#include <iostream>
+#include <cstdio>
 
-FaceDB::FaceDB(const std::string& dbPath) : filePath(dbPath), rng(std::random_device{}()) {
+#include "simd_kernels.hpp"
+
+FaceDB::FaceDB(const std::string& dbPath, const FaceDBOptions& opts)
+    : options(opts), filePath(dbPath), rng(std::random_device{}())
+{
+    index = makeIndex();
+    store.setSparseEmbeddingAccess(options.storage != StorageMode::Float);
+    if (options.gallery != "templates" && options.gallery != "centroid") {
+        std::cerr << "[FaceDB] Unknown gallery '" << options.gallery << "', using templates" << std::endl;
+        options.gallery = "templates";
+    }
     if (!filePath.empty()) {
         load(filePath);
     }
 }
 
+std::unique_ptr<FaceIndex> FaceDB::makeIndex() const {
+    if (options.storage != StorageMode::Float) {
+        if (options.index != "flat") {
+            std::cerr << "[FaceDB] Storage " << storageModeName(options.storage)
+                      << " only supports the flat scan, ignoring index '" << options.index << "'" << std::endl;
+        }
+        return std::make_unique<QuantizedIndex>(embeddings, options.storage,
+                                                static_cast<size_t>(std::max(options.rerankK, 1)));
+    }
+    if (options.index == "hnsw") {
+        return std::make_unique<HnswIndex>(embeddings, options.hnsw);
+    }
+    if (options.index != "flat") {
+        std::cerr << "[FaceDB] Unknown index '" << options.index << "', using flat" << std::endl;
+    }
+    return std::make_unique<FlatIndex>(embeddings);
+}
+
+void FaceDB::setScanPool(ThreadPool* pool) {
+    ParallelScanOptions parallel;
+    parallel.pool = pool;
+    parallel.minRows = options.parallelScanMinRows;
+    parallel.shardBytes = options.scanShardBytes;
+    parallel.maxThreads = static_cast<size_t>(std::max(options.parallelScanThreads, 0));
+
+    std::lock_guard<std::mutex> lock(writeMutex);
+    std::unique_lock<RwLock> rw(rwMutex);
+    index->setParallelScan(parallel);
+}
+
 FaceDB::~FaceDB() {
+    stopBackground();
     if (!filePath.empty()) {
         save(filePath);
     }
+    wal.close();
 }
 
 std::string FaceDB::generateId(const std::string& name) {
@@ -27,127 +74,528 @@ std::string FaceDB::generateId(const std::string& name) {
 
 void FaceDB::add(const std::string& name, const std::vector<float>& emb) {
     FaceRecord rec;
-    rec.id = generateId(name);
     rec.name = name;
-    rec.embedding = emb;
-    records.push_back(rec);
+    std::vector<FaceRecord> recs(1, std::move(rec));
+    if (appendRecords(std::move(recs), {emb.data()}, emb.size()) == 0) {
+        throw std::runtime_error("FaceDB: failed to persist record to " + store.path());
+    }
 }
 
-float FaceDB::cosineSimilarity(const std::vector<float>& a, const std::vector<float>& b) const {
-    if (a.size() != b.size() || a.empty()) return 0.0f; // Add size check
-    
-    float dot = 0.0f, normA = 0.0f, normB = 0.0f;
-    for (size_t i = 0; i < a.size(); ++i) {
-        dot += a[i] * b[i];
-        normA += a[i] * a[i];
-        normB += b[i] * b[i];
+size_t FaceDB::addBatch(const std::vector<std::string>& names, const std::vector<std::vector<float>>& embs) {
+    if (names.size() != embs.size()) {
+        throw std::invalid_argument("FaceDB: names / embeddings count mismatch");
     }
-    
-    float denominator = std::sqrt(normA) * std::sqrt(normB);
-    if (denominator < 1e-8) return 0.0f; // Prevent division by zero
-    
-    return dot / denominator;
+    if (embs.empty()) return 0;
+    std::vector<FaceRecord> recs(names.size());
+    std::vector<const float*> ptrs(embs.size());
+    for (size_t i = 0; i < embs.size(); ++i) {
+        if (embs[i].size() != embs[0].size()) {
+            throw std::invalid_argument("FaceDB: embedding size mismatch within batch");
+        }
+        recs[i].name = names[i];
+        ptrs[i] = embs[i].data();
+    }
+    return appendRecords(std::move(recs), ptrs, embs[0].size());
+}
+
+size_t FaceDB::appendRecords(std::vector<FaceRecord> recs, const std::vector<const float*>& embs, size_t dim) {
+    if (dim == 0) {
+        throw std::invalid_argument("FaceDB: empty embedding");
+    }
+
+    // Simpan dalam bentuk ter-normalisasi supaya find() cukup dot product
+    std::vector<std::vector<float>> normalized(recs.size());
+    for (size_t i = 0; i < recs.size(); ++i) {
+        normalized[i].assign(embs[i], embs[i] + dim);
+        simd::normalize(normalized[i].data(), dim);
+    }
+
+    uint64_t lsn = 0;
+    size_t added = 0;
+    {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        std::unique_lock<RwLock> rw(rwMutex);
+        if (loadFailed) {
+            throw std::runtime_error("FaceDB: " + filePath + " could not be loaded, refusing to write");
+        }
+        if (embeddings.dim() == 0 && !store.isOpen()) {
+            embeddings.reset(dim);
+        } else if (embeddings.dim() != dim) {
+            throw std::invalid_argument("FaceDB: embedding size mismatch (" + std::to_string(dim) +
+                                        " vs " + std::to_string(embeddings.dim()) + ")");
+        }
+        for (auto& rec : recs) {
+            if (rec.id.empty()) rec.id = generateId(rec.name);
+        }
+
+        size_t firstRow;
+        if (filePath.empty() && !store.isOpen()) {
+            firstRow = embeddings.rows();
+            for (const auto& emb : normalized) embeddings.append(emb.data());
+            added = recs.size();
+        } else {
+            // Mode persisten: row ditulis ke file, matrix hanya view mmap
+            if (!store.isOpen()) {
+                if (!store.create(filePath, dim)) {
+                    throw std::runtime_error("FaceDB: cannot create " + filePath);
+                }
+                if (options.wal && openWal(false)) startBackground();
+            }
+            firstRow = store.rows();
+            while (added < recs.size() && store.stage(recs[added], normalized[added].data())) ++added;
+            if (added < recs.size()) {
+                std::cerr << "[FaceDB] Failed to stage record in " << store.path() << std::endl;
+            }
+
+            if (wal.isOpen()) {
+                // Cukup stage ke mmap + record WAL; checkpoint dilakukan compactor
+                std::vector<WalEntry> entries(added);
+                for (size_t i = 0; i < added; ++i) {
+                    entries[i].row = firstRow + i;
+                    entries[i].id = recs[i].id;
+                    entries[i].name = recs[i].name;
+                    entries[i].embedding = std::move(normalized[i]);
+                }
+                lsn = wal.appendBatch(entries);
+            } else if (added > 0 && !store.checkpoint()) {
+                std::cerr << "[FaceDB] Failed to persist records to " << store.path() << std::endl;
+                store.discardStaged();
+                added = 0;
+            }
+            embeddings.attach(store.embeddingData(), store.dim(), store.stride(), store.rows());
+        }
+        for (size_t i = 0; i < added; ++i) pendingRecords.push_back(std::move(recs[i]));
+        if (!wal.isOpen()) {
+            publishPending(pendingRecords.size());  // in-memory, atau sudah di-checkpoint
+        } else if (lsn != 0) {
+            pendingLsn = lsn;
+        }
+    }
+
+    // Menunggu fsync di luar lock supaya add() lain bisa ikut group commit yang sama.
+    // Record baru bisa dicari setelah durable, jadi kegagalan WAL tidak meninggalkan
+    // identitas yang terlihat tapi tidak tersimpan.
+    if (lsn != 0) {
+        bool durable = wal.waitDurable(lsn);
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+            std::unique_lock<RwLock> rw(rwMutex);
+            settlePending(durable);
+        }
+        if (!durable) {
+            throw std::runtime_error("FaceDB: failed to write WAL for " + store.path());
+        }
+        if (wal.bytes() >= options.compactBytes) compactCv.notify_one();
+    }
+    return added;
 }
 
 std::pair<std::string, float> FaceDB::find(const std::vector<float>& queryEmb, float threshold) const {
-    float bestSim = -1.0f;
-    std::string bestName;
-    for (const auto& rec : records) {
-        float sim = cosineSimilarity(queryEmb, rec.embedding);
-        if (sim > bestSim) {
-            bestSim = sim;
-            bestName = rec.name; // Store name instead of ID
+    std::vector<FaceMatch> matches = search(queryEmb, 1, threshold);
+    if (matches.empty()) return {"", 0.0f};
+    return {matches[0].name, matches[0].score}; // Return name instead of ID
+}
+
+std::vector<FaceMatch> FaceDB::search(const std::vector<float>& queryEmb, size_t k, float threshold) const {
+    std::vector<FaceMatch> matches;
+    std::shared_lock<RwLock> lock(rwMutex);
+    if (records.empty() || k == 0 || queryEmb.size() != embeddings.dim()) return matches;
+
+    std::vector<float> query(queryEmb);
+    if (!simd::normalize(query.data(), query.size())) return matches;
+
+    if (centroidGallery() && centroids.size() > 0) return searchCentroidsLocked(query.data(), k, threshold);
+
+    // Index memakai TopK (min-heap k item), hasil sudah terurut
+    for (const SearchHit& hit : index->search(query.data(), k)) {
+        if (hit.score < threshold) break;
+        matches.push_back(FaceMatch{records[hit.row].id, records[hit.row].name, hit.score});
+    }
+    return matches;
+}
+
+std::vector<FaceMatch> FaceDB::searchCentroidsLocked(const float* query, size_t k, float threshold) const {
+    const size_t candidates = std::max(k, static_cast<size_t>(std::max(options.centroidFallbackCandidates, 1)));
+    std::vector<SearchHit> hits = centroids.search(query, candidates);
+    std::vector<FaceMatch> matches;
+    if (hits.empty()) return matches;
+
+    // Close call: dua identitas teratas berdekatan atau skor di sekitar threshold.
+    // Skor centroid dirata-rata, jadi kandidat di-scoring ulang dengan template terbaiknya.
+    const float margin = options.centroidFallbackMargin;
+    bool closeCall = margin > 0.0f &&
+                     ((hits.size() > 1 && hits[0].score - hits[1].score < margin) ||
+                      std::fabs(hits[0].score - threshold) < margin);
+
+    for (const SearchHit& hit : hits) {
+        const std::string& name = centroids.name(hit.row);
+        FaceMatch match{centroids.representativeId(hit.row), name, hit.score};
+        if (closeCall) {
+            match.score = -1.0f;
+            for (uint32_t row : nameRows.at(name)) {
+                float score = simd::dot(query, embeddings.row(row), embeddings.dim());
+                if (score > match.score) {
+                    match.score = score;
+                    match.id = records[row].id;
+                }
+            }
         }
+        matches.push_back(std::move(match));
     }
-    if (bestSim >= threshold) return {bestName, bestSim}; // Return name instead of ID
-    return {"", 0.0f};
+    if (closeCall) {
+        std::stable_sort(matches.begin(), matches.end(),
+                         [](const FaceMatch& a, const FaceMatch& b) { return a.score > b.score; });
+    }
+    while (!matches.empty() && matches.back().score < threshold) matches.pop_back();
+    if (matches.size() > k) matches.resize(k);
+    return matches;
 }
 
-bool FaceDB::save(const std::string& path) const {
-    std::string savePath = path.empty() ? filePath : path;
-    if (savePath.empty()) return false;
+void FaceDB::updateCentroid(const std::string& name) {
+    CentroidParams params;
+    params.outlierSigma = options.centroidOutlierSigma;
+    centroids.update(name, nameRows.at(name), embeddings, records, params);
+}
 
-    std::ofstream file(savePath, std::ios::binary);
-    if (!file.is_open()) return false;
+FaceMatch FaceDB::verifyClaim(const std::string& claimedName, const std::vector<float>& queryEmb,
+                              size_t* templates) const {
+    FaceMatch best;
+    best.score = -1.0f;
+    if (templates) *templates = 0;
 
-    uint32_t count = records.size();
-    file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    std::shared_lock<RwLock> lock(rwMutex);
+    auto it = nameRows.find(claimedName);
+    if (it == nameRows.end() || queryEmb.size() != embeddings.dim()) return FaceMatch();
 
-    for (const auto& rec : records) {
-        // id
-        uint32_t idLen = rec.id.size();
-        file.write(reinterpret_cast<const char*>(&idLen), sizeof(idLen));
-        file.write(rec.id.c_str(), idLen);
+    std::vector<float> query(queryEmb);
+    if (!simd::normalize(query.data(), query.size())) return FaceMatch();
 
-        // name
-        uint32_t nameLen = rec.name.size();
-        file.write(reinterpret_cast<const char*>(&nameLen), sizeof(nameLen));
-        file.write(rec.name.c_str(), nameLen);
+    for (uint32_t row : it->second) {
+        float score = simd::dot(query.data(), embeddings.row(row), embeddings.dim());
+        if (score > best.score) {
+            best.score = score;
+            best.id = records[row].id;
+        }
+    }
+    best.name = claimedName;
+    if (templates) *templates = it->second.size();
+    return best;
+}
+
+bool FaceDB::save(const std::string& path) {
+    std::string savePath = path.empty() ? filePath : path;
+    if (savePath.empty()) return false;
+    if (loadFailed && savePath == filePath) return false;  // jangan timpa file yang gagal dibaca
 
-        // embedding
-        uint32_t embSize = rec.embedding.size();
-        file.write(reinterpret_cast<const char*>(&embSize), sizeof(embSize));
-        file.write(reinterpret_cast<const char*>(rec.embedding.data()), embSize * sizeof(float));
+    // Record sudah durable di WAL, cukup lipat ke store
+    if (store.isOpen() && savePath == store.path()) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        return checkpointLocked();
     }
-    return true;
+    std::shared_lock<RwLock> rw(rwMutex);
+    if (pendingRecords.empty()) return FaceStore::writeSnapshot(savePath, records, embeddings);
+    // Row yang menunggu fsync WAL belum ikut snapshot
+    EmbeddingMatrix published;
+    published.attach(embeddings.data(), embeddings.dim(), embeddings.stride(), records.size());
+    return FaceStore::writeSnapshot(savePath, records, published);
 }
 
 bool FaceDB::load(const std::string& path) {
     std::string loadPath = path.empty() ? filePath : path;
     if (loadPath.empty()) return false;
 
-    std::ifstream file(loadPath, std::ios::binary);
-    if (!file.is_open()) return false;
+    stopBackground();
+    std::lock_guard<std::mutex> lock(writeMutex);
+    std::unique_lock<RwLock> rw(rwMutex);
+    wal.close();
+    resetMemory();
+    store.close();
+    loadFailed = false;
 
-    records.clear();
+    auto fail = [&]() {
+        loadFailed = true;
+        std::cerr << "[FaceDB] " << loadPath << " could not be loaded; registrations are refused until "
+                  << "the file is repaired or moved away" << std::endl;
+        return false;
+    };
 
-    uint32_t count;
-    if (!file.read(reinterpret_cast<char*>(&count), sizeof(count))) {
-        return false; // Add error checking
+    switch (FaceStore::probe(loadPath)) {
+        case FaceStore::FileKind::Missing:
+            return false;  // file dibuat saat add() pertama
+        case FaceStore::FileKind::Invalid:
+            std::cerr << "[FaceDB] Unrecognized file: " << loadPath << std::endl;
+            return fail();
+        case FaceStore::FileKind::Legacy:
+            if (!upgradeLegacy(loadPath)) return fail();
+            break;
+        case FaceStore::FileKind::Current:
+            break;
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    if (!store.open(loadPath)) {
+        std::cerr << "[FaceDB] Failed to open " << loadPath << std::endl;
+        return fail();
+    }
+    if (options.wal) openWal(true);
+    if (!store.readRecords(records)) {
+        std::cerr << "[FaceDB] Failed to read records from " << loadPath << std::endl;
+        wal.close();
+        store.close();
+        records.clear();
+        return fail();
+    }
+    embeddings.attach(store.embeddingData(), store.dim(), store.stride(), store.rows());
+    for (size_t i = 0; i < records.size(); ++i) {
+        index->add(static_cast<uint32_t>(i));
+        nameRows[records[i].name].push_back(static_cast<uint32_t>(i));
     }
-    
-    if (count > 100000) { // Sanity check for reasonable number of records
+    if (centroidGallery()) {
+        for (const auto& entry : nameRows) updateCentroid(entry.first);
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    std::cout << "[FaceDB] Loaded " << records.size() << " records in " << ms << " ms, index: " << index->name()
+              << ", kernel: " << simd::activeIsa()
+              << ", embeddings " << (embeddings.rows() * embeddings.stride() * sizeof(float)) / 1024 << " KB"
+              << ", index " << index->memoryBytes() / 1024 << " KB"
+              << ", WAL " << (wal.isOpen() ? "on" : "off") << std::endl;
+    if (centroidGallery()) {
+        std::cout << "[FaceDB] Gallery: " << centroids.size() << " identity centroids over " << records.size()
+                  << " templates, " << centroids.rejectedTemplates() << " outlier templates excluded" << std::endl;
+    }
+    if (options.selfCheckQueries > 0 && !records.empty()) {
+        IndexCheckReport r = selfCheckLocked(static_cast<size_t>(options.selfCheckQueries));
+        std::cout << "[FaceDB] Self-check " << r.queries << " queries: recall@" << r.k << " = " << r.recall
+                  << ", top1 = " << r.top1Agreement << ", top1 score delta = " << r.top1ScoreDelta;
+        if (options.storage != StorageMode::Float) {
+            std::cout << ", first-pass score error = " << r.approxScoreError;
+        }
+        std::cout << ", exact " << r.exactMsPerQuery << " ms, " << index->name() << " "
+                  << r.indexMsPerQuery << " ms per query" << std::endl;
+    }
+    // Index int8/fp16 sudah punya code sendiri: float cukup dibaca dari file saat re-rank
+    if (options.storage != StorageMode::Float) store.setSparseEmbeddingAccess(true);
+    startBackground();
+    return true;
+}
+
+bool FaceDB::upgradeLegacy(const std::string& path) {
+    const std::string converted = path + ".v2";
+    size_t count = 0;
+    if (!FaceStore::convertLegacy(path, converted, &count)) {
+        std::cerr << "[FaceDB] Failed to convert legacy file: " << path << std::endl;
         return false;
     }
+    // File lama disimpan sebagai backup
+    if (std::rename(path.c_str(), (path + ".legacy").c_str()) != 0 ||
+        std::rename(converted.c_str(), path.c_str()) != 0) {
+        std::cerr << "[FaceDB] Failed to replace legacy file: " << path << std::endl;
+        return false;
+    }
+    std::cout << "[FaceDB] Converted " << count << " legacy records to format v"
+              << FaceStore::kVersion << " (backup: " << path << ".legacy)" << std::endl;
+    return true;
+}
 
-    for (uint32_t i = 0; i < count; ++i) {
-        FaceRecord rec;
+bool FaceDB::openWal(bool replayLog) {
+    const std::string walPath = store.path() + ".wal";
+    if (!wal.open(walPath, std::chrono::microseconds(std::max(options.walGroupCommitUs, 0)))) {
+        std::cerr << "[FaceDB] Cannot open WAL " << walPath << ", checkpointing every add" << std::endl;
+        return false;
+    }
 
-        // id
-        uint32_t idLen;
-        if (!file.read(reinterpret_cast<char*>(&idLen), sizeof(idLen)) || idLen > 1000) {
-            return false; // Add bounds checking
-        }
-        rec.id.resize(idLen);
-        if (!file.read(&rec.id[0], idLen)) {
+    // Tanpa replay (store baru dibuat) isi log lama dibuang oleh checkpoint di bawah
+    if (replayLog) {
+        size_t before = store.rows();
+        bool stageFailed = false;
+        size_t seen = wal.replay([&](const WalEntry& e) {
+            if (e.row < store.rows()) return true;  // sudah ada di snapshot
+            if (e.row != store.rows() || e.embedding.size() != store.dim()) {
+                std::cerr << "[FaceDB] WAL record for row " << e.row << " does not match store ("
+                          << store.rows() << " rows), ignoring the rest of the log" << std::endl;
+                return false;
+            }
+            FaceRecord rec{e.id, e.name};
+            if (!store.stage(rec, e.embedding.data())) {
+                stageFailed = true;
+                return false;
+            }
+            return true;
+        });
+        if (stageFailed) {
+            // Log dibiarkan utuh untuk start berikutnya
+            std::cerr << "[FaceDB] Failed to apply WAL to " << store.path() << std::endl;
+            wal.close();
             return false;
         }
-
-        // name
-        uint32_t nameLen;
-        if (!file.read(reinterpret_cast<char*>(&nameLen), sizeof(nameLen)) || nameLen > 1000) {
-            return false; // Add bounds checking  
-        }
-        rec.name.resize(nameLen);
-        if (!file.read(&rec.name[0], nameLen)) {
-            return false;
+        if (store.rows() > before) {
+            std::cout << "[FaceDB] Replayed " << (store.rows() - before) << " of " << seen
+                      << " WAL records" << std::endl;
         }
+    }
+    if (!checkpointLocked()) {
+        std::cerr << "[FaceDB] Checkpoint after WAL replay failed" << std::endl;
+        wal.close();
+        return false;
+    }
+    return true;
+}
 
-        // embedding
-        uint32_t embSize;
-        if (!file.read(reinterpret_cast<char*>(&embSize), sizeof(embSize)) || embSize > 10000) {
-            return false; // Add bounds checking
-        }
-        rec.embedding.resize(embSize);
-        if (!file.read(reinterpret_cast<char*>(rec.embedding.data()), embSize * sizeof(float))) {
-            return false;
+bool FaceDB::checkpointLocked() {
+    if (!store.isOpen()) return false;
+    if (store.rows() == store.count() && wal.bytes() == 0) return true;
+    // Row staged hanya boleh di-commit setelah record WAL-nya durable
+    if (wal.isOpen() && !wal.flush()) return false;
+    if (!store.checkpoint()) return false;
+    return !wal.isOpen() || wal.reset();
+}
+
+void FaceDB::compactLoop() {
+    const auto interval = std::chrono::seconds(std::max(options.compactIntervalSec, 1));
+    std::unique_lock<std::mutex> lock(writeMutex);
+    while (!stopCompactor) {
+        compactCv.wait_for(lock, interval, [this] {
+            return stopCompactor || wal.bytes() >= options.compactBytes;
+        });
+        if (stopCompactor) break;
+        if (!checkpointLocked()) {
+            std::cerr << "[FaceDB] Background checkpoint failed: " << store.path() << std::endl;
+            compactCv.wait_for(lock, interval, [this] { return stopCompactor; });
         }
+    }
+}
 
-        records.push_back(rec);
+void FaceDB::startBackground() {
+    // Thread langsung menunggu writeMutex, aman dipanggil saat lock dipegang
+    if (wal.isOpen() && !compactor.joinable()) {
+        compactor = std::thread(&FaceDB::compactLoop, this);
     }
-    return true;
 }
 
-void FaceDB::clear() {
+void FaceDB::stopBackground() {
+    {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        stopCompactor = true;
+    }
+    compactCv.notify_all();
+    if (compactor.joinable()) compactor.join();
+    stopCompactor = false;
+}
+
+void FaceDB::publishPending(size_t n) {
+    n = std::min(n, pendingRecords.size());
+    const size_t first = records.size();
+    for (size_t i = 0; i < n; ++i) {
+        const uint32_t row = static_cast<uint32_t>(first + i);
+        nameRows[pendingRecords[i].name].push_back(row);
+        records.push_back(std::move(pendingRecords[i]));
+        index->add(row);
+    }
+    pendingRecords.erase(pendingRecords.begin(), pendingRecords.begin() + n);
+    if (centroidGallery()) {
+        for (size_t i = first; i < records.size(); ++i) updateCentroid(records[i].name);
+    }
+}
+
+void FaceDB::settlePending(bool walOk) {
+    if (pendingRecords.empty()) return;  // sudah dipublikasikan writer lain, atau DB di-reload
+    // LSN berurutan dengan row: entry terakhir pendingRecords = pendingLsn
+    const uint64_t durable = wal.durableLsn();
+    const size_t undurable = durable >= pendingLsn
+        ? 0 : static_cast<size_t>(std::min<uint64_t>(pendingLsn - durable, pendingRecords.size()));
+    publishPending(pendingRecords.size() - undurable);
+    if (walOk || pendingRecords.empty()) return;
+
+    // WAL gagal (permanen): row yang belum durable dibuang dari store supaya
+    // tidak ikut checkpoint berikutnya
+    std::cerr << "[FaceDB] Dropping " << pendingRecords.size() << " records that never reached the WAL"
+              << std::endl;
+    pendingRecords.clear();
+    store.discardStaged(records.size());
+    embeddings.attach(store.embeddingData(), store.dim(), store.stride(), store.rows());
+}
+
+void FaceDB::resetMemory() {
     records.clear();
+    pendingRecords.clear();
+    nameRows.clear();
+    embeddings.clear();
+    index->clear();
+    centroids.clear();
+}
+
+void FaceDB::clear() {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    std::unique_lock<RwLock> rw(rwMutex);
+    if (loadFailed) return;
+    resetMemory();
+    if (store.isOpen()) {
+        std::string path = store.path();
+        size_t dim = store.dim();
+        store.close();
+        store.create(path, dim);
+        if (wal.isOpen()) wal.reset();
+        embeddings.attach(store.embeddingData(), store.dim(), store.stride(), 0);
+    }
+}
+
+IndexCheckReport FaceDB::selfCheck(size_t queries, size_t k) const {
+    std::shared_lock<RwLock> lock(rwMutex);
+    return selfCheckLocked(queries, k);
+}
+
+IndexCheckReport FaceDB::selfCheckLocked(size_t queries, size_t k) const {
+    IndexCheckReport report;
+    report.k = k;
+    if (records.empty() || queries == 0 || k == 0) return report;
+
+    FlatIndex exact(embeddings);
+    for (size_t i = 0; i < records.size(); ++i) exact.add(static_cast<uint32_t>(i));
+
+    // Query = embedding tersimpan + noise kecil, mendekati kondisi /verify
+    std::mt19937 gen(1234);
+    std::uniform_int_distribution<size_t> pick(0, records.size() - 1);
+    std::normal_distribution<float> noise(0.0f, 0.02f);
+    std::vector<float> query(embeddings.dim());
+
+    using Clock = std::chrono::steady_clock;
+    const QuantizedIndex* quantized = dynamic_cast<const QuantizedIndex*>(index.get());
+    double exactMs = 0.0, indexMs = 0.0, recallSum = 0.0, deltaSum = 0.0, approxErrSum = 0.0;
+    size_t top1Match = 0;
+    for (size_t q = 0; q < queries; ++q) {
+        const float* src = embeddings.row(pick(gen));
+        for (size_t d = 0; d < query.size(); ++d) query[d] = src[d] + noise(gen);
+        simd::normalize(query.data(), query.size());
+
+        auto t0 = Clock::now();
+        std::vector<SearchHit> truth = exact.search(query.data(), k);
+        auto t1 = Clock::now();
+        std::vector<SearchHit> approx = index->search(query.data(), k);
+        auto t2 = Clock::now();
+        exactMs += std::chrono::duration<double, std::milli>(t1 - t0).count();
+        indexMs += std::chrono::duration<double, std::milli>(t2 - t1).count();
+
+        size_t found = 0;
+        for (const auto& t : truth) {
+            for (const auto& a : approx) {
+                if (a.row == t.row) { ++found; break; }
+            }
+        }
+        recallSum += static_cast<double>(found) / truth.size();
+        if (!approx.empty() && approx[0].row == truth[0].row) ++top1Match;
+        if (!approx.empty()) deltaSum += std::fabs(approx[0].score - truth[0].score);
+        if (quantized) {
+            approxErrSum += std::fabs(quantized->approxScore(query.data(), truth[0].row) - truth[0].score);
+        }
+    }
+
+    report.queries = queries;
+    report.recall = static_cast<float>(recallSum / queries);
+    report.top1Agreement = static_cast<float>(top1Match) / queries;
+    report.top1ScoreDelta = static_cast<float>(deltaSum / queries);
+    report.approxScoreError = static_cast<float>(approxErrSum / queries);
+    report.exactMsPerQuery = exactMs / queries;
+    report.indexMsPerQuery = indexMs / queries;
+    return report;
 }
\ No newline at end of file
@@ -5,31 +5,145 @@
 #include <string>
 #include <random>
 #include <fstream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <condition_variable>
+#include <unordered_map>
 
-struct FaceRecord {
+#include "embedding_matrix.hpp"
+#include "face_store.hpp"
+#include "face_index.hpp"
+#include "hnsw_index.hpp"
+#include "quantized_index.hpp"
+#include "write_ahead_log.hpp"
+#include "identity_centroids.hpp"
+#include "rw_lock.hpp"
+
+struct FaceDBOptions {
+    std::string index = "flat";     // "flat" (exact) atau "hnsw"
+    HnswParams hnsw;
+    StorageMode storage = StorageMode::Float;  // int8/fp16: scan code lalu re-rank float
+    int rerankK = 32;
+    int selfCheckQueries = 0;       // > 0: cek recall index vs exact setelah load
+    bool wal = true;                // false: checkpoint file pada setiap add
+    int walGroupCommitUs = 500;     // jendela group commit fsync
+    int compactIntervalSec = 30;    // periode checkpoint + kosongkan WAL
+    size_t compactBytes = 4 << 20;  // checkpoint lebih awal bila WAL melebihi ukuran ini
+    // "templates": 1:N scan semua template. "centroid": scan satu centroid per
+    // identitas, template hanya di-scan ulang untuk kandidat yang skornya berdekatan.
+    std::string gallery = "templates";
+    float centroidOutlierSigma = 2.0f;
+    float centroidFallbackMargin = 0.05f;  // 0 = tanpa fallback ke template
+    int centroidFallbackCandidates = 3;
+    // Scan flat/int8/fp16 paralel di thread pool dari setScanPool() bila galeri
+    // >= parallelScanMinRows; shard berukuran scanShardBytes
+    size_t parallelScanMinRows = 100000;
+    size_t scanShardBytes = 1 << 20;
+    int parallelScanThreads = 0;    // 0 = seluruh pool
+};
+
+struct FaceMatch {
     std::string id;
     std::string name;
-    std::vector<float> embedding;
+    float score = 0.0f;
+};
+
+// Hasil perbandingan index aktif terhadap scan exact
+struct IndexCheckReport {
+    size_t queries = 0;
+    size_t k = 0;
+    float recall = 0.0f;            // rata-rata |topK_index ∩ topK_exact| / k
+    float top1Agreement = 0.0f;
+    float top1ScoreDelta = 0.0f;    // rata-rata |skor top1 index - skor top1 exact|
+    float approxScoreError = 0.0f;  // storage int8/fp16: error skor tahap pertama
+    double exactMsPerQuery = 0.0;
+    double indexMsPerQuery = 0.0;
 };
 
+// Thread-safe: find()/size()/selfCheck() boleh paralel (shared lock),
+// add()/clear()/load() eksklusif terhadap pembaca.
 class FaceDB {
 public:
-    FaceDB(const std::string& dbPath = "");
+    FaceDB(const std::string& dbPath = "", const FaceDBOptions& options = FaceDBOptions());
     ~FaceDB();
 
     void add(const std::string& name, const std::vector<float>& emb);
+    // Enrollment massal: satu lock, satu fsync WAL (atau satu checkpoint tanpa WAL).
+    // Return jumlah record yang tersimpan, selalu prefix dari input; throw bila
+    // ukuran embedding tidak cocok (tidak ada yang ditambahkan).
+    size_t addBatch(const std::vector<std::string>& names, const std::vector<std::vector<float>>& embs);
     std::pair<std::string, float> find(const std::vector<float>& queryEmb, float threshold = 0.6) const;
-    bool save(const std::string& path = "") const;
+    // 1:N, maksimal k hasil dengan skor >= threshold, terurut dari skor tertinggi
+    std::vector<FaceMatch> search(const std::vector<float>& queryEmb, size_t k, float threshold = -1.0f) const;
+    // 1:1, hanya template milik claimedName yang di-scan. Return template dengan
+    // skor tertinggi (name kosong bila nama tidak terdaftar); templates = jumlah template.
+    FaceMatch verifyClaim(const std::string& claimedName, const std::vector<float>& queryEmb,
+                          size_t* templates = nullptr) const;
+    bool save(const std::string& path = "");
     bool load(const std::string& path = "");
     void clear();
 
+    size_t size() const {
+        std::shared_lock<RwLock> lock(rwMutex);
+        return records.size();
+    }
+    size_t identities() const {
+        std::shared_lock<RwLock> lock(rwMutex);
+        return nameRows.size();
+    }
+    const char* indexName() const { return index->name(); }
+    // Pool dipakai bersama server (tidak membuat thread per query); nullptr = single-thread.
+    // Pool harus hidup lebih lama dari FaceDB atau dilepas dulu dengan setScanPool(nullptr).
+    void setScanPool(ThreadPool* pool);
+    IndexCheckReport selfCheck(size_t queries, size_t k = 10) const;
+
 private:
     std::vector<FaceRecord> records;
+    std::unordered_map<std::string, std::vector<uint32_t>> nameRows;  // name -> row, untuk 1:1
+    EmbeddingMatrix embeddings;     // view ke store bila persisten
+    FaceStore store;
+    FaceDBOptions options;
+    std::unique_ptr<FaceIndex> index;
+    IdentityCentroids centroids;    // hanya diisi bila gallery == "centroid"
     std::string filePath;
     std::mt19937 rng;
+    // File ada tapi gagal dibaca: semua tulis ditolak supaya galeri tidak
+    // tertimpa file kosong oleh add() / save() berikutnya
+    bool loadFailed = false;
+    // Row yang sudah di-stage + masuk WAL tapi fsync-nya belum selesai. Baru
+    // masuk records/index setelah durable; dibuang dari store bila WAL gagal.
+    std::vector<FaceRecord> pendingRecords;
+    uint64_t pendingLsn = 0;        // LSN entry terakhir di pendingRecords
+
+    // rwMutex: pembaca vs perubahan records/embeddings/index (stage bisa remap file).
+    // writeMutex: serialisasi penulis + compactor. Urutan lock: writeMutex -> rwMutex.
+    mutable RwLock rwMutex;
+    std::mutex writeMutex;
+
+    // Log registrasi di <filePath>.wal, dilipat ke store oleh thread compactor
+    WriteAheadLog wal;
+    std::condition_variable compactCv;
+    std::thread compactor;
+    bool stopCompactor = false;
     
     std::string generateId(const std::string& name);
-    float cosineSimilarity(const std::vector<float>& a, const std::vector<float>& b) const;
+    size_t appendRecords(std::vector<FaceRecord> recs, const std::vector<const float*>& embs, size_t dim);
+    std::unique_ptr<FaceIndex> makeIndex() const;
+    bool centroidGallery() const { return options.gallery == "centroid"; }
+    void updateCentroid(const std::string& name);
+    std::vector<FaceMatch> searchCentroidsLocked(const float* query, size_t k, float threshold) const;
+    IndexCheckReport selfCheckLocked(size_t queries, size_t k = 10) const;
+    bool upgradeLegacy(const std::string& path);
+    void resetMemory();
+    void publishPending(size_t n);
+    void settlePending(bool walOk);
+    bool openWal(bool replayLog);
+    bool checkpointLocked();
+    void compactLoop();
+    void startBackground();
+    void stopBackground();
 };
 
 #endif
\ No newline at end of file
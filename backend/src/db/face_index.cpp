@@ -0,0 +1,48 @@
+#include "face_index.hpp"
+#include "simd_kernels.hpp"
+#include "parallel_scan.hpp"
+#include <algorithm>
+
+namespace {
+
+bool higherScore(const SearchHit& a, const SearchHit& b) {
+    return a.score > b.score;
+}
+
+} // namespace
+
+void TopK::push(uint32_t row, float score) {
+    if (k_ == 0) return;
+    if (heap_.size() < k_) {
+        heap_.push_back({row, score});
+        std::push_heap(heap_.begin(), heap_.end(), higherScore);
+    } else if (score > heap_.front().score) {
+        std::pop_heap(heap_.begin(), heap_.end(), higherScore);
+        heap_.back() = {row, score};
+        std::push_heap(heap_.begin(), heap_.end(), higherScore);
+    }
+}
+
+std::vector<SearchHit> TopK::take() {
+    std::sort_heap(heap_.begin(), heap_.end(), higherScore);
+    std::vector<SearchHit> out;
+    out.swap(heap_);
+    return out;
+}
+
+std::vector<SearchHit> FlatIndex::search(const float* query, size_t k) const {
+    if (k == 0 || size_ == 0) return {};
+
+    auto scan = [&](size_t begin, size_t end, TopK& top) {
+        constexpr size_t kBlock = 256;
+        float scores[kBlock];
+        for (size_t start = begin; start < end; start += kBlock) {
+            size_t n = std::min(kBlock, end - start);
+            simd::dotBatch(query, matrix_.row(start), n, matrix_.stride(), matrix_.dim(), scores);
+            for (size_t i = 0; i < n; ++i) {
+                top.push(static_cast<uint32_t>(start + i), scores[i]);
+            }
+        }
+    };
+    return parallelTopK(size_, matrix_.stride() * sizeof(float), k, parallel_, scan);
+}
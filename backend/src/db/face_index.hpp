@@ -0,0 +1,80 @@
+#ifndef FACE_INDEX_HPP
+#define FACE_INDEX_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "embedding_matrix.hpp"
+
+struct SearchHit {
+    uint32_t row;
+    float score;   // cosine similarity (embedding sudah ter-normalisasi)
+};
+
+// Mengumpulkan k hit dengan skor tertinggi (min-heap di atas vector)
+class TopK {
+public:
+    explicit TopK(size_t k) : k_(k) { heap_.reserve(k); }
+
+    void push(uint32_t row, float score);
+    bool full() const { return heap_.size() >= k_; }
+    float minScore() const { return heap_.front().score; }
+
+    // Mengosongkan heap, hasil terurut dari skor tertinggi
+    std::vector<SearchHit> take();
+
+private:
+    size_t k_;
+    std::vector<SearchHit> heap_;
+};
+
+class ThreadPool;
+
+// Scan paralel untuk index brute-force (lihat parallel_scan.hpp)
+struct ParallelScanOptions {
+    ThreadPool* pool = nullptr;   // milik pemanggil (server), harus hidup lebih lama dari index
+    size_t minRows = 100000;      // di bawah ini scan tetap single-thread
+    size_t shardBytes = 1 << 20;  // ukuran shard ~ L2, diambil dinamis oleh tiap thread
+    size_t maxThreads = 0;        // 0 = semua thread pool + thread pemanggil
+};
+
+// Index di atas EmbeddingMatrix milik FaceDB. Index tidak menyimpan salinan
+// vector, hanya row id; row ke-i selalu di-add berurutan.
+class FaceIndex {
+public:
+    virtual ~FaceIndex() = default;
+
+    virtual const char* name() const = 0;
+    virtual void add(uint32_t row) = 0;
+    virtual void clear() = 0;
+    virtual size_t size() const = 0;
+    // Memori tambahan milik index (di luar EmbeddingMatrix)
+    virtual size_t memoryBytes() const { return 0; }
+    // Diabaikan oleh index graph (HNSW); tidak boleh diubah saat search berjalan
+    void setParallelScan(const ParallelScanOptions& options) { parallel_ = options; }
+
+    // Hasil terurut dari skor tertinggi, maksimal k item
+    virtual std::vector<SearchHit> search(const float* query, size_t k) const = 0;
+
+protected:
+    ParallelScanOptions parallel_;
+};
+
+// Brute-force scan, hasil exact
+class FlatIndex : public FaceIndex {
+public:
+    explicit FlatIndex(const EmbeddingMatrix& matrix) : matrix_(matrix) {}
+
+    const char* name() const override { return "flat"; }
+    void add(uint32_t row) override { size_ = row + 1; }
+    void clear() override { size_ = 0; }
+    size_t size() const override { return size_; }
+    std::vector<SearchHit> search(const float* query, size_t k) const override;
+
+private:
+    const EmbeddingMatrix& matrix_;
+    size_t size_ = 0;
+};
+
+#endif
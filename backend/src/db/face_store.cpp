@@ -0,0 +1,497 @@
+#include "face_store.hpp"
+#include "crc32.hpp"
+#include "simd_kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t dim;
+    uint32_t stride;
+    uint32_t reserved;
+    uint64_t sequence;
+    uint64_t count;
+    uint64_t capacity;
+    uint64_t strOffset;
+    uint64_t strBytes;
+    uint64_t strCapacity;
+    uint32_t checksum;   // crc32c dari semua field sebelumnya
+    uint32_t pad;
+};
+
+const char kMagic[8] = {'F', 'A', 'C', 'E', 'D', 'B', '\0', '\2'};
+constexpr uint64_t kHeaderPage = 4096;
+constexpr uint64_t kSlotOffset[2] = {0, 512};   // sektor berbeda
+constexpr size_t kMaxStringLen = 0xffff;
+// Perkiraan string table per row (u16 x2 + id "<nama>_xxxxxxxx" + nama)
+constexpr uint64_t kStringBytesPerRow = 48;
+
+uint64_t embeddingBytes(size_t capacity, size_t stride) {
+    return static_cast<uint64_t>(capacity) * stride * sizeof(float);
+}
+
+void appendStringEntry(std::vector<unsigned char>& out, const FaceRecord& rec) {
+    uint16_t idLen = static_cast<uint16_t>(rec.id.size());
+    uint16_t nameLen = static_cast<uint16_t>(rec.name.size());
+    size_t pos = out.size();
+    out.resize(pos + 4 + idLen + nameLen);
+    std::memcpy(&out[pos], &idLen, 2);
+    std::memcpy(&out[pos + 2], &nameLen, 2);
+    std::memcpy(&out[pos + 4], rec.id.data(), idLen);
+    std::memcpy(&out[pos + 4 + idLen], rec.name.data(), nameLen);
+}
+
+bool syncDirectoryOf(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    std::string dir = (slash == std::string::npos) ? "." : path.substr(0, slash == 0 ? 1 : slash);
+    int dfd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dfd < 0) return false;
+    bool ok = ::fsync(dfd) == 0;
+    ::close(dfd);
+    return ok;
+}
+
+bool writeAll(int fd, const void* data, size_t len, uint64_t offset) {
+    const char* p = static_cast<const char*>(data);
+    while (len > 0) {
+        ssize_t n = ::pwrite(fd, p, len, static_cast<off_t>(offset));
+        if (n <= 0) return false;
+        p += n;
+        len -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+// Menulis file versi 2 lengkap ke tmp lalu rename atomik ke path. Row dan
+// string di luar bagian committed ikut disalin tapi tidak masuk header.
+static bool buildFile(const std::string& path, size_t dim, size_t stride, size_t capacity,
+                      const float* rows, size_t rowCount, size_t committedRows,
+                      const std::vector<unsigned char>& strings, uint64_t committedStrBytes,
+                      uint64_t strCapacity, uint64_t sequence) {
+    const uint64_t strOffset = kHeaderPage + embeddingBytes(capacity, stride);
+    const uint64_t fileSize = strOffset + strCapacity;
+    const std::string tmpPath = path + ".tmp";
+
+    int fd = ::open(tmpPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+
+    unsigned char page[kHeaderPage] = {};
+    FileHeader h{};
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version = FaceStore::kVersion;
+    h.dim = static_cast<uint32_t>(dim);
+    h.stride = static_cast<uint32_t>(stride);
+    h.sequence = sequence;
+    h.count = committedRows;
+    h.capacity = capacity;
+    h.strOffset = strOffset;
+    h.strBytes = committedStrBytes;
+    h.strCapacity = strCapacity;
+    h.checksum = crc32c(&h, offsetof(FileHeader, checksum));
+    std::memcpy(page + kSlotOffset[0], &h, sizeof(h));
+
+    bool ok = ::ftruncate(fd, static_cast<off_t>(fileSize)) == 0 &&
+              writeAll(fd, page, sizeof(page), 0) &&
+              (rowCount == 0 || writeAll(fd, rows, embeddingBytes(rowCount, stride), kHeaderPage)) &&
+              (strings.empty() || writeAll(fd, strings.data(), strings.size(), strOffset)) &&
+              ::fsync(fd) == 0;
+    ::close(fd);
+
+    if (!ok || ::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        ::unlink(tmpPath.c_str());
+        return false;
+    }
+    syncDirectoryOf(path);
+    return true;
+}
+
+FaceStore::~FaceStore() {
+    close();
+}
+
+FaceStore::FileKind FaceStore::probe(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return FileKind::Missing;
+    std::streamoff size = file.tellg();
+    if (size == 0) return FileKind::Missing;
+    if (size < 4) return FileKind::Invalid;
+
+    // Magic dicek di kedua slot: slot 0 yang sobek (crash saat commit header)
+    // tidak boleh membuat file v2 dianggap format lama lalu dikonversi
+    for (uint64_t offset : kSlotOffset) {
+        char magic[8] = {};
+        if (size < static_cast<std::streamoff>(offset + sizeof(magic))) break;
+        file.clear();
+        file.seekg(static_cast<std::streamoff>(offset));
+        if (file.read(magic, sizeof(magic)) && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0) {
+            return FileKind::Current;
+        }
+    }
+    return FileKind::Legacy;
+}
+
+bool FaceStore::map(const std::string& path) {
+    close();
+    fd_ = ::open(path.c_str(), O_RDWR);
+    if (fd_ < 0) return false;
+
+    struct stat st;
+    if (::fstat(fd_, &st) != 0 || static_cast<uint64_t>(st.st_size) < kHeaderPage) {
+        close();
+        return false;
+    }
+    mappedBytes_ = static_cast<size_t>(st.st_size);
+    void* p = ::mmap(nullptr, mappedBytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED) {
+        mappedBytes_ = 0;
+        close();
+        return false;
+    }
+    base_ = static_cast<unsigned char*>(p);
+    path_ = path;
+    return true;
+}
+
+void FaceStore::close() {
+    if (base_) {
+        ::munmap(base_, mappedBytes_);
+        base_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    mappedBytes_ = 0;
+    count_ = staged_ = capacity_ = dim_ = stride_ = 0;
+    strBytes_ = stagedStrBytes_ = 0;
+}
+
+bool FaceStore::loadHeader() {
+    const FileHeader* best = nullptr;
+    int bestSlot = 0;
+    for (int slot = 0; slot < 2; ++slot) {
+        const FileHeader* h = reinterpret_cast<const FileHeader*>(base_ + kSlotOffset[slot]);
+        if (std::memcmp(h->magic, kMagic, sizeof(kMagic)) != 0) continue;
+        if (h->checksum != crc32c(h, offsetof(FileHeader, checksum))) continue;
+        if (!best || h->sequence > best->sequence) {
+            best = h;
+            bestSlot = slot;
+        }
+    }
+    if (!best || best->version != kVersion) return false;
+
+    const uint64_t strOffset = kHeaderPage + embeddingBytes(best->capacity, best->stride);
+    if (best->dim == 0 || best->stride < best->dim || best->stride % EmbeddingMatrix::kRowAlign != 0 ||
+        best->count > best->capacity || best->strOffset != strOffset ||
+        best->strBytes > best->strCapacity || strOffset + best->strCapacity > mappedBytes_) {
+        return false;
+    }
+
+    activeSlot_ = bestSlot;
+    sequence_ = best->sequence;
+    dim_ = best->dim;
+    stride_ = best->stride;
+    count_ = best->count;
+    capacity_ = best->capacity;
+    strOffset_ = best->strOffset;
+    strBytes_ = best->strBytes;
+    strCapacity_ = best->strCapacity;
+    staged_ = count_;
+    stagedStrBytes_ = strBytes_;
+    return true;
+}
+
+bool FaceStore::open(const std::string& path) {
+    if (!map(path)) return false;
+    if (!loadHeader()) {
+        std::cerr << "[FaceStore] Invalid header: " << path << std::endl;
+        close();
+        return false;
+    }
+    if (sparseAccess_) adviseEmbeddings();
+    return true;
+}
+
+void FaceStore::setSparseEmbeddingAccess(bool sparse) {
+    sparseAccess_ = sparse;
+    adviseEmbeddings();
+}
+
+void FaceStore::adviseEmbeddings() const {
+    if (!base_ || capacity_ == 0) return;
+    // Blok embedding mulai di kHeaderPage (page aligned). MAP_SHARED: page
+    // kotor yang dilepas tetap ada di page cache dan ditulis ke file.
+    unsigned char* block = base_ + kHeaderPage;
+    const size_t len = capacity_ * stride_ * sizeof(float);
+    if (sparseAccess_) {
+        ::madvise(block, len, MADV_DONTNEED);
+        ::madvise(block, len, MADV_RANDOM);
+    } else {
+        ::madvise(block, len, MADV_NORMAL);
+    }
+}
+
+bool FaceStore::create(const std::string& path, size_t dim, size_t rowCapacity) {
+    EmbeddingMatrix empty;
+    empty.reset(dim);
+    return writeSnapshot(path, {}, empty, rowCapacity) && open(path);
+}
+
+const float* FaceStore::embeddingData() const {
+    return base_ ? reinterpret_cast<const float*>(base_ + kHeaderPage) : nullptr;
+}
+
+bool FaceStore::syncRange(uint64_t offset, uint64_t len) const {
+    if (len == 0) return true;
+    const uint64_t page = static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+    uint64_t start = offset / page * page;
+    return ::msync(base_ + start, static_cast<size_t>(offset + len - start), MS_SYNC) == 0;
+}
+
+bool FaceStore::sync() const {
+    return base_ && ::msync(base_, mappedBytes_, MS_SYNC) == 0;
+}
+
+bool FaceStore::commitHeader() {
+    int slot = 1 - activeSlot_;
+    FileHeader h{};
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version = kVersion;
+    h.dim = static_cast<uint32_t>(dim_);
+    h.stride = static_cast<uint32_t>(stride_);
+    h.sequence = sequence_ + 1;
+    h.count = count_;
+    h.capacity = capacity_;
+    h.strOffset = strOffset_;
+    h.strBytes = strBytes_;
+    h.strCapacity = strCapacity_;
+    h.checksum = crc32c(&h, offsetof(FileHeader, checksum));
+
+    std::memcpy(base_ + kSlotOffset[slot], &h, sizeof(h));
+    if (!syncRange(kSlotOffset[slot], sizeof(h))) return false;
+    activeSlot_ = slot;
+    sequence_ = h.sequence;
+    return true;
+}
+
+bool FaceStore::grow(size_t minRows, uint64_t minStrBytes) {
+    // Hanya region yang penuh yang digandakan; string table ikut disesuaikan
+    // dengan kapasitas row baru supaya tidak penuh lebih dulu untuk nama biasa
+    size_t newCapacity = minRows > capacity_ ? std::max(capacity_ * 2, minRows) : capacity_;
+    uint64_t newStrCapacity = minStrBytes > strCapacity_ ? std::max(strCapacity_ * 2, minStrBytes) : strCapacity_;
+    if (newCapacity > capacity_) {
+        newStrCapacity = std::max<uint64_t>(newStrCapacity, newCapacity * kStringBytesPerRow);
+    }
+    std::vector<unsigned char> strings(base_ + strOffset_, base_ + strOffset_ + stagedStrBytes_);
+
+    std::string path = path_;
+    size_t staged = staged_;
+    uint64_t stagedStrBytes = stagedStrBytes_;
+    if (!buildFile(path, dim_, stride_, newCapacity, embeddingData(), staged_, count_,
+                   strings, strBytes_, newStrCapacity, sequence_ + 1)) {
+        return false;
+    }
+    if (!open(path)) return false;
+    staged_ = staged;
+    stagedStrBytes_ = stagedStrBytes;
+    return true;
+}
+
+bool FaceStore::stage(const FaceRecord& rec, const float* emb) {
+    if (!base_) return false;
+    if (rec.id.size() > kMaxStringLen || rec.name.size() > kMaxStringLen) return false;
+
+    std::vector<unsigned char> entry;
+    appendStringEntry(entry, rec);
+
+    const bool rowsFull = staged_ >= capacity_;
+    const bool stringsFull = stagedStrBytes_ + entry.size() > strCapacity_;
+    if (rowsFull || stringsFull) {
+        if (!grow(rowsFull ? staged_ + 1 : 0, stringsFull ? stagedStrBytes_ + entry.size() : 0)) return false;
+    }
+
+    // Ditulis di luar area committed, belum di-sync
+    float* row = reinterpret_cast<float*>(base_ + kHeaderPage + embeddingBytes(staged_, stride_));
+    std::memcpy(row, emb, dim_ * sizeof(float));
+    std::fill(row + dim_, row + stride_, 0.0f);
+    std::memcpy(base_ + strOffset_ + stagedStrBytes_, entry.data(), entry.size());
+    ++staged_;
+    stagedStrBytes_ += entry.size();
+    return true;
+}
+
+bool FaceStore::checkpoint() {
+    if (!base_) return false;
+    if (staged_ == count_) return true;
+
+    // 1. sync data yang di-stage, 2. commit lewat header
+    if (!syncRange(kHeaderPage + embeddingBytes(count_, stride_), embeddingBytes(staged_ - count_, stride_)) ||
+        !syncRange(strOffset_ + strBytes_, stagedStrBytes_ - strBytes_)) {
+        return false;
+    }
+    size_t prevCount = count_;
+    uint64_t prevStrBytes = strBytes_;
+    count_ = staged_;
+    strBytes_ = stagedStrBytes_;
+    if (!commitHeader()) {
+        count_ = prevCount;
+        strBytes_ = prevStrBytes;
+        return false;
+    }
+    return true;
+}
+
+void FaceStore::discardStaged() {
+    staged_ = count_;
+    stagedStrBytes_ = strBytes_;
+}
+
+void FaceStore::discardStaged(size_t keepRows) {
+    if (keepRows <= count_) {
+        discardStaged();
+        return;
+    }
+    if (keepRows >= staged_) return;
+    // Posisi string table untuk row keepRows: lewati entry staged sebelumnya
+    uint64_t offset = strBytes_;
+    for (size_t i = count_; i < keepRows; ++i) {
+        uint16_t idLen, nameLen;
+        std::memcpy(&idLen, base_ + strOffset_ + offset, 2);
+        std::memcpy(&nameLen, base_ + strOffset_ + offset + 2, 2);
+        offset += 4 + static_cast<uint64_t>(idLen) + nameLen;
+    }
+    staged_ = keepRows;
+    stagedStrBytes_ = offset;
+}
+
+bool FaceStore::append(const FaceRecord& rec, const float* emb) {
+    if (!stage(rec, emb)) return false;
+    if (!checkpoint()) {
+        discardStaged();
+        return false;
+    }
+    return true;
+}
+
+bool FaceStore::readRecords(std::vector<FaceRecord>& out) const {
+    out.clear();
+    if (!base_) return false;
+    out.reserve(staged_);
+
+    const unsigned char* p = base_ + strOffset_;
+    const unsigned char* end = p + stagedStrBytes_;
+    for (size_t i = 0; i < staged_; ++i) {
+        if (end - p < 4) return false;
+        uint16_t idLen, nameLen;
+        std::memcpy(&idLen, p, 2);
+        std::memcpy(&nameLen, p + 2, 2);
+        p += 4;
+        if (static_cast<size_t>(end - p) < static_cast<size_t>(idLen) + nameLen) return false;
+        FaceRecord rec;
+        rec.id.assign(reinterpret_cast<const char*>(p), idLen);
+        rec.name.assign(reinterpret_cast<const char*>(p + idLen), nameLen);
+        p += idLen + nameLen;
+        out.push_back(std::move(rec));
+    }
+    return true;
+}
+
+bool FaceStore::writeSnapshot(const std::string& path, const std::vector<FaceRecord>& records,
+                              const EmbeddingMatrix& embeddings, size_t rowCapacity) {
+    if (embeddings.dim() == 0 || records.size() != embeddings.rows()) return false;
+
+    std::vector<unsigned char> strings;
+    for (const auto& rec : records) {
+        if (rec.id.size() > kMaxStringLen || rec.name.size() > kMaxStringLen) return false;
+        appendStringEntry(strings, rec);
+    }
+
+    size_t capacity = std::max<size_t>({rowCapacity, records.size() * 2, 16});
+    uint64_t strCapacity = std::max<uint64_t>({strings.size() * 2, capacity * kStringBytesPerRow, kHeaderPage});
+    return buildFile(path, embeddings.dim(), embeddings.stride(), capacity,
+                     embeddings.data(), records.size(), records.size(),
+                     strings, strings.size(), strCapacity, 1);
+}
+
+bool FaceStore::readLegacy(const std::string& path, std::vector<FaceRecord>& records,
+                           EmbeddingMatrix& embeddings) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return false;
+    const uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+
+    records.clear();
+    embeddings.clear();
+
+    uint32_t count;
+    if (!file.read(reinterpret_cast<char*>(&count), sizeof(count))) {
+        return false;
+    }
+    // Sanity check: setiap record minimal 3 field panjang (12 byte)
+    if (static_cast<uint64_t>(count) * 12 > fileSize) {
+        return false;
+    }
+
+    std::vector<float> emb;
+    for (uint32_t i = 0; i < count; ++i) {
+        FaceRecord rec;
+
+        uint32_t idLen;
+        if (!file.read(reinterpret_cast<char*>(&idLen), sizeof(idLen)) || idLen > 1000) return false;
+        rec.id.resize(idLen);
+        if (!file.read(&rec.id[0], idLen)) return false;
+
+        uint32_t nameLen;
+        if (!file.read(reinterpret_cast<char*>(&nameLen), sizeof(nameLen)) || nameLen > 1000) return false;
+        rec.name.resize(nameLen);
+        if (!file.read(&rec.name[0], nameLen)) return false;
+
+        uint32_t embSize;
+        if (!file.read(reinterpret_cast<char*>(&embSize), sizeof(embSize)) || embSize == 0 || embSize > 10000) {
+            return false;
+        }
+        emb.resize(embSize);
+        if (!file.read(reinterpret_cast<char*>(emb.data()), embSize * sizeof(float))) return false;
+
+        if (i == 0) {
+            embeddings.reset(embSize);
+            embeddings.reserve(count);
+            records.reserve(count);
+        } else if (embSize != embeddings.dim()) {
+            return false;
+        }
+
+        float norm = std::sqrt(simd::dot(emb.data(), emb.data(), embSize));
+        if (norm > 1e-8f) {
+            for (float& v : emb) v /= norm;
+        }
+        embeddings.append(emb.data());
+        records.push_back(std::move(rec));
+    }
+    return true;
+}
+
+bool FaceStore::convertLegacy(const std::string& legacyPath, const std::string& outPath, size_t* converted) {
+    std::vector<FaceRecord> records;
+    EmbeddingMatrix embeddings;
+    if (!readLegacy(legacyPath, records, embeddings)) return false;
+    if (embeddings.dim() == 0) embeddings.reset(512);  // file lama kosong
+    if (!writeSnapshot(outPath, records, embeddings)) return false;
+    if (converted) *converted = records.size();
+    return true;
+}
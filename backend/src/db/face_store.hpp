@@ -0,0 +1,102 @@
+#ifndef FACE_STORE_HPP
+#define FACE_STORE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "embedding_matrix.hpp"
+
+// Side table: record ke-i memiliki embedding di row ke-i dari EmbeddingMatrix
+struct FaceRecord {
+    std::string id;
+    std::string name;
+};
+
+// File face_db.bin versi 2, di-mmap dan dibaca langsung tanpa copy.
+//
+//   [0, 4096)              header page, dua slot header (offset 0 dan 512)
+//   [4096, strOffset)      blok embedding: capacity row x stride float
+//   [strOffset, EOF)       string table: per record u16 idLen, u16 nameLen, id, name
+//
+// Record baru di-stage di belakang data yang sudah committed. checkpoint()
+// men-sync data tersebut lalu menulis header ke slot yang sedang tidak aktif
+// dengan sequence lebih tinggi. Crash sebelum checkpoint hanya meninggalkan
+// record yang belum committed (durability-nya dijamin WriteAheadLog).
+class FaceStore {
+public:
+    enum class FileKind { Missing, Legacy, Current, Invalid };
+
+    static constexpr uint32_t kVersion = 2;
+
+    FaceStore() = default;
+    ~FaceStore();
+    FaceStore(const FaceStore&) = delete;
+    FaceStore& operator=(const FaceStore&) = delete;
+
+    static FileKind probe(const std::string& path);
+
+    bool open(const std::string& path);
+    bool create(const std::string& path, size_t dim, size_t rowCapacity = 1024);
+    void close();
+    bool isOpen() const { return base_ != nullptr; }
+
+    // Embedding harus sudah ter-normalisasi. stage() langsung terlihat di
+    // embeddingData()/rows() tapi baru durable setelah checkpoint().
+    bool stage(const FaceRecord& rec, const float* emb);
+    bool checkpoint();
+    // Buang row yang di-stage tapi belum di-checkpoint
+    void discardStaged();
+    // Sama, tapi row staged sebelum keepRows dipertahankan (keepRows >= count())
+    void discardStaged(size_t keepRows);
+    // stage + checkpoint, durable saat return true
+    bool append(const FaceRecord& rec, const float* emb);
+    bool sync() const;
+
+    bool readRecords(std::vector<FaceRecord>& out) const;
+
+    // Scan memakai code int8/fp16: float hanya dibaca untuk re-rank beberapa row.
+    // Page blok embedding dilepas dari memori proses (data tetap di file / page
+    // cache) dan readahead dimatikan; berlaku juga setelah file di-remap.
+    void setSparseEmbeddingAccess(bool sparse);
+
+    const float* embeddingData() const;
+    const std::string& path() const { return path_; }
+    size_t count() const { return count_; }     // committed
+    size_t rows() const { return staged_; }     // committed + staged
+    size_t capacity() const { return capacity_; }
+    size_t dim() const { return dim_; }
+    size_t stride() const { return stride_; }
+
+    // Tulis snapshot lengkap (file sementara lalu rename)
+    static bool writeSnapshot(const std::string& path, const std::vector<FaceRecord>& records,
+                              const EmbeddingMatrix& embeddings, size_t rowCapacity = 0);
+
+    // Format lama: u32 count lalu per record (u32 len, id, u32 len, name, u32 dim, float[dim])
+    static bool readLegacy(const std::string& path, std::vector<FaceRecord>& records,
+                           EmbeddingMatrix& embeddings);
+    static bool convertLegacy(const std::string& legacyPath, const std::string& outPath,
+                              size_t* converted = nullptr);
+
+private:
+    std::string path_;
+    int fd_ = -1;
+    unsigned char* base_ = nullptr;
+    size_t mappedBytes_ = 0;
+
+    uint64_t sequence_ = 0;
+    int activeSlot_ = 0;
+    size_t dim_ = 0, stride_ = 0;
+    size_t count_ = 0, staged_ = 0, capacity_ = 0;
+    uint64_t strOffset_ = 0, strBytes_ = 0, stagedStrBytes_ = 0, strCapacity_ = 0;
+    bool sparseAccess_ = false;
+
+    bool map(const std::string& path);
+    bool loadHeader();
+    bool commitHeader();
+    bool syncRange(uint64_t offset, uint64_t len) const;
+    bool grow(size_t minRows, uint64_t minStrBytes);
+    void adviseEmbeddings() const;
+};
+
+#endif
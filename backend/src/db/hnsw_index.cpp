@@ -0,0 +1,257 @@
+#include "hnsw_index.hpp"
+#include "simd_kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <queue>
+
+namespace {
+
+// Penanda node yang sudah dikunjungi, satu per thread supaya search()
+// tidak perlu alokasi atau lock. Epoch dinaikkan per query.
+struct VisitedList {
+    std::vector<uint32_t> tags;
+    uint32_t epoch = 0;
+
+    void prepare(size_t n) {
+        if (tags.size() < n) tags.resize(n, 0);
+        if (++epoch == 0) {
+            std::fill(tags.begin(), tags.end(), 0);
+            epoch = 1;
+        }
+    }
+    bool visit(uint32_t node) {
+        if (tags[node] == epoch) return false;
+        tags[node] = epoch;
+        return true;
+    }
+};
+
+VisitedList& visitedList() {
+    thread_local VisitedList list;
+    return list;
+}
+
+} // namespace
+
+HnswIndex::HnswIndex(const EmbeddingMatrix& matrix, const HnswParams& params)
+    : matrix_(matrix),
+      params_(params),
+      maxM_(static_cast<size_t>(std::max(2, params.M))),
+      maxM0_(2 * maxM_),
+      levelMult_(1.0 / std::log(static_cast<double>(maxM_))),
+      rng_(params.seed)
+{
+    params_.M = static_cast<int>(maxM_);
+    params_.efConstruction = std::max(params_.efConstruction, params_.M);
+    params_.efSearch = std::max(params_.efSearch, 1);
+}
+
+float HnswIndex::distance(const float* q, uint32_t node) const {
+    return 1.0f - simd::dot(q, matrix_.row(node), matrix_.dim());
+}
+
+float HnswIndex::distance(uint32_t a, uint32_t b) const {
+    return distance(matrix_.row(a), b);
+}
+
+int HnswIndex::randomLevel() {
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    double r = std::max(dist(rng_), 1e-12);
+    return static_cast<int>(-std::log(r) * levelMult_);
+}
+
+size_t HnswIndex::neighborCount(uint32_t node, int layer) const {
+    if (layer == 0) return links0_[node * (maxM0_ + 1)];
+    return upper_[node][layer - 1].size();
+}
+
+const uint32_t* HnswIndex::neighbors(uint32_t node, int layer) const {
+    if (layer == 0) return &links0_[node * (maxM0_ + 1) + 1];
+    return upper_[node][layer - 1].data();
+}
+
+void HnswIndex::setNeighbors(uint32_t node, int layer, const std::vector<uint32_t>& nbrs) {
+    if (layer == 0) {
+        uint32_t* slot = &links0_[node * (maxM0_ + 1)];
+        slot[0] = static_cast<uint32_t>(nbrs.size());
+        std::copy(nbrs.begin(), nbrs.end(), slot + 1);
+    } else {
+        upper_[node][layer - 1] = nbrs;
+    }
+}
+
+uint32_t HnswIndex::greedyDescend(const float* q, uint32_t ep, int fromLayer, int toLayer) const {
+    float epDist = distance(q, ep);
+    for (int layer = fromLayer; layer > toLayer; --layer) {
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            const uint32_t* nbrs = neighbors(ep, layer);
+            size_t n = neighborCount(ep, layer);
+            for (size_t i = 0; i < n; ++i) {
+                float d = distance(q, nbrs[i]);
+                if (d < epDist) {
+                    epDist = d;
+                    ep = nbrs[i];
+                    changed = true;
+                }
+            }
+        }
+    }
+    return ep;
+}
+
+std::vector<HnswIndex::Candidate> HnswIndex::searchLayer(const float* q,
+                                                         const std::vector<Candidate>& entryPoints,
+                                                         size_t ef, int layer) const {
+    VisitedList& visited = visitedList();
+    visited.prepare(levels_.size());
+
+    // candidates: min-heap (terdekat dulu), results: max-heap (terjauh di top)
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates;
+    std::priority_queue<Candidate> results;
+
+    for (const auto& ep : entryPoints) {
+        if (!visited.visit(ep.second)) continue;
+        candidates.push(ep);
+        results.push(ep);
+        if (results.size() > ef) results.pop();
+    }
+
+    while (!candidates.empty()) {
+        Candidate current = candidates.top();
+        if (current.first > results.top().first && results.size() >= ef) break;
+        candidates.pop();
+
+        const uint32_t* nbrs = neighbors(current.second, layer);
+        size_t n = neighborCount(current.second, layer);
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t nb = nbrs[i];
+            if (!visited.visit(nb)) continue;
+            float d = distance(q, nb);
+            if (results.size() < ef || d < results.top().first) {
+                candidates.push({d, nb});
+                results.push({d, nb});
+                if (results.size() > ef) results.pop();
+            }
+        }
+    }
+
+    std::vector<Candidate> out(results.size());
+    for (size_t i = out.size(); i-- > 0;) {
+        out[i] = results.top();
+        results.pop();
+    }
+    return out;
+}
+
+std::vector<uint32_t> HnswIndex::selectNeighbors(const std::vector<Candidate>& sorted, size_t m) const {
+    // Heuristik diversifikasi: kandidat dibuang bila lebih dekat ke neighbor
+    // yang sudah terpilih daripada ke titik query
+    std::vector<uint32_t> selected;
+    selected.reserve(m);
+    for (const auto& cand : sorted) {
+        if (selected.size() >= m) break;
+        bool keep = true;
+        for (uint32_t s : selected) {
+            if (distance(cand.second, s) < cand.first) {
+                keep = false;
+                break;
+            }
+        }
+        if (keep) selected.push_back(cand.second);
+    }
+    // Isi sisa slot dengan kandidat terdekat supaya graph tetap terhubung
+    for (const auto& cand : sorted) {
+        if (selected.size() >= m) break;
+        if (std::find(selected.begin(), selected.end(), cand.second) == selected.end())
+            selected.push_back(cand.second);
+    }
+    return selected;
+}
+
+void HnswIndex::connect(uint32_t from, uint32_t to, int layer) {
+    size_t limit = (layer == 0) ? maxM0_ : maxM_;
+    size_t n = neighborCount(from, layer);
+    const uint32_t* nbrs = neighbors(from, layer);
+
+    std::vector<uint32_t> list(nbrs, nbrs + n);
+    list.push_back(to);
+    if (list.size() <= limit) {
+        setNeighbors(from, layer, list);
+        return;
+    }
+
+    std::vector<Candidate> cands;
+    cands.reserve(list.size());
+    for (uint32_t nb : list) cands.push_back({distance(from, nb), nb});
+    std::sort(cands.begin(), cands.end());
+    setNeighbors(from, layer, selectNeighbors(cands, limit));
+}
+
+void HnswIndex::add(uint32_t row) {
+    if (row != levels_.size()) return;  // row harus di-add berurutan
+
+    int level = randomLevel();
+    levels_.push_back(level);
+    links0_.resize(levels_.size() * (maxM0_ + 1), 0);
+    upper_.emplace_back(static_cast<size_t>(level));
+
+    if (maxLevel_ < 0) {
+        entry_ = row;
+        maxLevel_ = level;
+        return;
+    }
+
+    const float* q = matrix_.row(row);
+    uint32_t ep = greedyDescend(q, entry_, maxLevel_, level);
+    std::vector<Candidate> entryPoints{{distance(q, ep), ep}};
+
+    for (int layer = std::min(level, maxLevel_); layer >= 0; --layer) {
+        std::vector<Candidate> cands = searchLayer(q, entryPoints,
+                                                   static_cast<size_t>(params_.efConstruction), layer);
+        std::vector<uint32_t> selected = selectNeighbors(cands, maxM_);
+        setNeighbors(row, layer, selected);
+        for (uint32_t nb : selected) connect(nb, row, layer);
+        entryPoints = std::move(cands);
+    }
+
+    if (level > maxLevel_) {
+        maxLevel_ = level;
+        entry_ = row;
+    }
+}
+
+void HnswIndex::clear() {
+    levels_.clear();
+    links0_.clear();
+    upper_.clear();
+    maxLevel_ = -1;
+    entry_ = 0;
+}
+
+size_t HnswIndex::memoryBytes() const {
+    size_t bytes = links0_.size() * sizeof(uint32_t) + levels_.size() * sizeof(int);
+    for (const auto& node : upper_) {
+        for (const auto& layer : node) bytes += layer.size() * sizeof(uint32_t);
+    }
+    return bytes;
+}
+
+std::vector<SearchHit> HnswIndex::search(const float* query, size_t k) const {
+    std::vector<SearchHit> hits;
+    if (k == 0 || maxLevel_ < 0) return hits;
+
+    uint32_t ep = greedyDescend(query, entry_, maxLevel_, 0);
+    size_t ef = std::max(static_cast<size_t>(params_.efSearch), k);
+    std::vector<Candidate> found = searchLayer(query, {{distance(query, ep), ep}}, ef, 0);
+
+    size_t n = std::min(k, found.size());
+    hits.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        hits.push_back({found[i].second, 1.0f - found[i].first});
+    }
+    return hits;
+}
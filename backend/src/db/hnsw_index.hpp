@@ -0,0 +1,63 @@
+#ifndef HNSW_INDEX_HPP
+#define HNSW_INDEX_HPP
+
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "face_index.hpp"
+
+struct HnswParams {
+    int M = 16;                 // jumlah neighbor per node (layer 0 memakai 2*M)
+    int efConstruction = 200;   // lebar beam saat insert
+    int efSearch = 64;          // lebar beam saat query
+    unsigned seed = 100;
+};
+
+// Hierarchical Navigable Small World graph (Malkov & Yashunin) dengan jarak
+// 1 - dot. Insert incremental, search read-only sehingga aman dipanggil
+// paralel selama tidak ada insert yang berjalan.
+class HnswIndex : public FaceIndex {
+public:
+    HnswIndex(const EmbeddingMatrix& matrix, const HnswParams& params);
+
+    const char* name() const override { return "hnsw"; }
+    void add(uint32_t row) override;
+    void clear() override;
+    size_t size() const override { return levels_.size(); }
+    size_t memoryBytes() const override;
+    std::vector<SearchHit> search(const float* query, size_t k) const override;
+
+    const HnswParams& params() const { return params_; }
+
+private:
+    using Candidate = std::pair<float, uint32_t>;  // (distance, node)
+
+    const EmbeddingMatrix& matrix_;
+    HnswParams params_;
+    size_t maxM_, maxM0_;
+    double levelMult_;
+    std::mt19937 rng_;
+
+    std::vector<int> levels_;
+    std::vector<uint32_t> links0_;                          // per node: [count, n_0 .. n_{maxM0-1}]
+    std::vector<std::vector<std::vector<uint32_t>>> upper_; // upper_[node][layer - 1]
+    int maxLevel_ = -1;
+    uint32_t entry_ = 0;
+
+    float distance(const float* q, uint32_t node) const;
+    float distance(uint32_t a, uint32_t b) const;
+    int randomLevel();
+
+    size_t neighborCount(uint32_t node, int layer) const;
+    const uint32_t* neighbors(uint32_t node, int layer) const;
+    void setNeighbors(uint32_t node, int layer, const std::vector<uint32_t>& nbrs);
+
+    uint32_t greedyDescend(const float* q, uint32_t ep, int fromLayer, int toLayer) const;
+    std::vector<Candidate> searchLayer(const float* q, const std::vector<Candidate>& entryPoints,
+                                       size_t ef, int layer) const;
+    std::vector<uint32_t> selectNeighbors(const std::vector<Candidate>& sorted, size_t m) const;
+    void connect(uint32_t from, uint32_t to, int layer);
+};
+
+#endif
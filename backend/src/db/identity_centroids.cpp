@@ -0,0 +1,139 @@
+#include "identity_centroids.hpp"
+#include <algorithm>
+#include <cmath>
+
+#include "simd_kernels.hpp"
+
+bool aggregateTemplates(const EmbeddingMatrix& templates, const std::vector<uint32_t>& rows,
+                        const CentroidParams& params, float* out, size_t* used) {
+    const size_t dim = templates.dim();
+    auto meanOf = [&](const std::vector<uint32_t>& subset) {
+        std::fill(out, out + dim, 0.0f);
+        for (uint32_t r : subset) {
+            const float* v = templates.row(r);
+            for (size_t d = 0; d < dim; ++d) out[d] += v[d];
+        }
+        return simd::normalize(out, dim);
+    };
+
+    if (used) *used = rows.size();
+    if (rows.empty() || !meanOf(rows)) return false;
+    if (params.outlierSigma <= 0.0f || rows.size() < 3) return true;
+
+    std::vector<float> sims(rows.size());
+    float mean = 0.0f;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        sims[i] = simd::dot(out, templates.row(rows[i]), dim);
+        mean += sims[i];
+    }
+    mean /= rows.size();
+    float var = 0.0f;
+    for (float s : sims) var += (s - mean) * (s - mean);
+    const float cutoff = mean - params.outlierSigma * std::sqrt(var / rows.size());
+
+    std::vector<uint32_t> kept;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if (sims[i] >= cutoff) kept.push_back(rows[i]);
+    }
+    if (kept.size() == rows.size() || kept.empty()) return true;
+    if (used) *used = kept.size();
+    return meanOf(kept);
+}
+
+void IdentityCentroids::clear() {
+    matrix_.clear();
+    index_.clear();
+    names_.clear();
+    representative_.clear();
+    rejected_.clear();
+    slots_.clear();
+}
+
+void IdentityCentroids::update(const std::string& name, const std::vector<uint32_t>& rows,
+                               const EmbeddingMatrix& templates, const std::vector<FaceRecord>& records,
+                               const CentroidParams& params) {
+    if (matrix_.dim() != templates.dim()) {
+        clear();
+        matrix_.reset(templates.dim());
+    }
+    std::vector<float> centroid(templates.dim());
+    size_t used = 0;
+    if (!aggregateTemplates(templates, rows, params, centroid.data(), &used)) return;
+
+    uint32_t best = rows.front();
+    float bestScore = -2.0f;
+    for (uint32_t r : rows) {
+        float s = simd::dot(centroid.data(), templates.row(r), templates.dim());
+        if (s > bestScore) {
+            bestScore = s;
+            best = r;
+        }
+    }
+
+    auto it = slots_.find(name);
+    if (it == slots_.end()) {
+        uint32_t slot = static_cast<uint32_t>(matrix_.append(centroid.data()));
+        index_.add(slot);
+        slots_[name] = slot;
+        names_.push_back(name);
+        representative_.push_back(records[best].id);
+        rejected_.push_back(rows.size() - used);
+    } else {
+        matrix_.set(it->second, centroid.data());
+        representative_[it->second] = records[best].id;
+        rejected_[it->second] = rows.size() - used;
+    }
+}
+
+size_t IdentityCentroids::rejectedTemplates() const {
+    size_t total = 0;
+    for (size_t r : rejected_) total += r;
+    return total;
+}
+
+CompactionReport compactTemplates(const std::vector<FaceRecord>& records, const EmbeddingMatrix& templates,
+                                  const CompactionParams& params, std::vector<FaceRecord>& outRecords,
+                                  EmbeddingMatrix& outTemplates) {
+    CompactionReport report;
+    report.templatesIn = records.size();
+    outRecords.clear();
+    outTemplates.reset(templates.dim());
+
+    std::vector<std::string> order;
+    std::unordered_map<std::string, std::vector<uint32_t>> byName;
+    for (size_t i = 0; i < records.size(); ++i) {
+        auto& rows = byName[records[i].name];
+        if (rows.empty()) order.push_back(records[i].name);
+        rows.push_back(static_cast<uint32_t>(i));
+    }
+    report.identities = order.size();
+
+    const size_t dim = templates.dim();
+    std::vector<float> merged(dim);
+    for (const auto& name : order) {
+        // Greedy: template masuk cluster pertama yang seed-nya cukup mirip
+        std::vector<std::vector<uint32_t>> clusters;
+        for (uint32_t r : byName[name]) {
+            bool placed = false;
+            for (auto& c : clusters) {
+                if (simd::dot(templates.row(c.front()), templates.row(r), dim) >= params.mergeThreshold) {
+                    c.push_back(r);
+                    placed = true;
+                    break;
+                }
+            }
+            if (!placed) clusters.push_back({r});
+        }
+        std::stable_sort(clusters.begin(), clusters.end(),
+                         [](const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) { return a.size() > b.size(); });
+        if (params.maxTemplates > 0 && clusters.size() > params.maxTemplates) clusters.resize(params.maxTemplates);
+
+        for (const auto& c : clusters) {
+            if (!aggregateTemplates(templates, c, params.centroid, merged.data())) continue;
+            outTemplates.append(merged.data());
+            outRecords.push_back(records[c.front()]);  // id seed cluster dipertahankan
+        }
+    }
+    report.templatesOut = outRecords.size();
+    return report;
+}
@@ -0,0 +1,73 @@
+#ifndef IDENTITY_CENTROIDS_HPP
+#define IDENTITY_CENTROIDS_HPP
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "embedding_matrix.hpp"
+#include "face_index.hpp"
+#include "face_store.hpp"
+
+struct CentroidParams {
+    // Template dengan cosine ke mean < rata-rata - outlierSigma * stddev dibuang
+    // dari centroid (min. 3 template). 0 = tanpa outlier rejection.
+    float outlierSigma = 2.0f;
+};
+
+// Rata-rata ter-normalisasi dari rows di templates; out berukuran dim.
+// used = jumlah template yang dipakai setelah outlier rejection.
+bool aggregateTemplates(const EmbeddingMatrix& templates, const std::vector<uint32_t>& rows,
+                        const CentroidParams& params, float* out, size_t* used = nullptr);
+
+// Satu centroid per identitas (nama) di atas template milik FaceDB. Scan
+// galeri jadi O(jumlah orang) alih-alih O(jumlah registrasi).
+class IdentityCentroids {
+public:
+    IdentityCentroids() : index_(matrix_) {}
+    IdentityCentroids(const IdentityCentroids&) = delete;
+    IdentityCentroids& operator=(const IdentityCentroids&) = delete;
+
+    void clear();
+    // Hitung ulang centroid satu identitas dari rows-nya (dipanggil setelah add/load)
+    void update(const std::string& name, const std::vector<uint32_t>& rows, const EmbeddingMatrix& templates,
+                const std::vector<FaceRecord>& records, const CentroidParams& params);
+
+    // row pada SearchHit = slot identitas
+    std::vector<SearchHit> search(const float* query, size_t k) const { return index_.search(query, k); }
+    const std::string& name(uint32_t slot) const { return names_[slot]; }
+    // Template yang paling dekat ke centroid, sebagai id perwakilan
+    const std::string& representativeId(uint32_t slot) const { return representative_[slot]; }
+
+    size_t size() const { return names_.size(); }
+    size_t rejectedTemplates() const;
+
+private:
+    EmbeddingMatrix matrix_;
+    FlatIndex index_;
+    std::vector<std::string> names_;
+    std::vector<std::string> representative_;
+    std::vector<size_t> rejected_;
+    std::unordered_map<std::string, uint32_t> slots_;
+};
+
+struct CompactionParams {
+    float mergeThreshold = 0.95f;  // template dengan cosine >= ini dianggap redundan dan di-merge
+    size_t maxTemplates = 0;       // > 0: sisakan maksimal N cluster terbesar per identitas
+    CentroidParams centroid;
+};
+
+struct CompactionReport {
+    size_t identities = 0;
+    size_t templatesIn = 0;
+    size_t templatesOut = 0;
+};
+
+// Merge template redundan per identitas (clustering greedy; cluster diganti
+// rata-rata ter-normalisasinya). Urutan identitas mengikuti kemunculan pertama.
+CompactionReport compactTemplates(const std::vector<FaceRecord>& records, const EmbeddingMatrix& templates,
+                                  const CompactionParams& params, std::vector<FaceRecord>& outRecords,
+                                  EmbeddingMatrix& outTemplates);
+
+#endif
@@ -0,0 +1,83 @@
+#include "parallel_scan.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+#include "util/thread_pool.hpp"
+
+namespace {
+
+struct ScanState {
+    ShardScanFn scan;
+    size_t rows = 0;
+    size_t shardRows = 0;
+    size_t shards = 0;
+    size_t k = 0;
+    std::atomic<size_t> next{0};
+
+    std::mutex mutex;
+    std::condition_variable done;
+    size_t finished = 0;
+    std::vector<SearchHit> hits;  // gabungan top-k per thread
+
+    // Return false bila shard sudah habis sebelum thread ini sempat mengambil
+    bool work() {
+        TopK top(k);
+        size_t scanned = 0;
+        for (size_t s = next.fetch_add(1); s < shards; s = next.fetch_add(1)) {
+            size_t begin = s * shardRows;
+            scan(begin, std::min(begin + shardRows, rows), top);
+            ++scanned;
+        }
+        if (scanned == 0) return false;
+        std::vector<SearchHit> local = top.take();
+        std::lock_guard<std::mutex> lock(mutex);
+        hits.insert(hits.end(), local.begin(), local.end());
+        finished += scanned;
+        if (finished == shards) done.notify_all();
+        return true;
+    }
+};
+
+} // namespace
+
+std::vector<SearchHit> parallelTopK(size_t rows, size_t rowBytes, size_t k,
+                                    const ParallelScanOptions& options, const ShardScanFn& scan) {
+    if (k == 0 || rows == 0) return {};
+
+    const size_t shardRows = std::max<size_t>(options.shardBytes / std::max<size_t>(rowBytes, 1), 64);
+    const size_t shards = (rows + shardRows - 1) / shardRows;
+    size_t helpers = options.pool ? std::min(options.pool->size(), shards - 1) : 0;
+    if (options.maxThreads > 0) helpers = std::min(helpers, options.maxThreads - 1);
+
+    if (rows < options.minRows || helpers == 0) {
+        TopK top(k);
+        scan(0, rows, top);
+        return top.take();
+    }
+
+    // State dipegang shared_ptr: job yang baru jalan setelah scan selesai
+    // hanya melihat shard habis lalu keluar
+    auto state = std::make_shared<ScanState>();
+    state->scan = scan;
+    state->rows = rows;
+    state->shardRows = shardRows;
+    state->shards = shards;
+    state->k = k;
+    for (size_t i = 0; i < helpers; ++i) {
+        try {
+            options.pool->submit([state]() { state->work(); });
+        } catch (const std::exception&) {
+            break;  // pool sedang berhenti, sisa shard dikerjakan pemanggil
+        }
+    }
+    state->work();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&] { return state->finished == state->shards; });
+    TopK merged(k);
+    for (const SearchHit& hit : state->hits) merged.push(hit.row, hit.score);
+    return merged.take();
+}
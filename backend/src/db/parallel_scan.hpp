@@ -0,0 +1,20 @@
+#ifndef PARALLEL_SCAN_HPP
+#define PARALLEL_SCAN_HPP
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "face_index.hpp"
+
+// scan(begin, end, top): skor row [begin, end) ke TopK milik thread tersebut
+using ShardScanFn = std::function<void(size_t, size_t, TopK&)>;
+
+// Top-k atas rows yang dibagi menjadi shard berukuran shardBytes. Thread
+// pemanggil ikut mengambil shard, jadi aman dipanggil dari job di pool yang
+// sama (tidak menunggu job yang belum sempat jalan). Tiap thread punya TopK
+// sendiri; hasil di-merge setelah semua shard selesai.
+std::vector<SearchHit> parallelTopK(size_t rows, size_t rowBytes, size_t k,
+                                    const ParallelScanOptions& options, const ShardScanFn& scan);
+
+#endif
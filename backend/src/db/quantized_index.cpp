@@ -0,0 +1,114 @@
+#include "quantized_index.hpp"
+#include "simd_kernels.hpp"
+#include "parallel_scan.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+StorageMode parseStorageMode(const std::string& name) {
+    if (name == "int8") return StorageMode::Int8;
+    if (name == "fp16") return StorageMode::Fp16;
+    if (name != "float") {
+        std::cerr << "[FaceDB] Unknown storage '" << name << "', using float" << std::endl;
+    }
+    return StorageMode::Float;
+}
+
+const char* storageModeName(StorageMode mode) {
+    switch (mode) {
+        case StorageMode::Int8: return "int8";
+        case StorageMode::Fp16: return "fp16";
+        default: return "float";
+    }
+}
+
+QuantizedIndex::QuantizedIndex(const EmbeddingMatrix& matrix, StorageMode mode, size_t rerankK)
+    : matrix_(matrix), mode_(mode), rerankK_(std::max<size_t>(rerankK, 1)) {}
+
+float QuantizedIndex::quantizeInt8(const float* v, size_t dim, int8_t* out) {
+    float maxAbs = 0.0f;
+    for (size_t i = 0; i < dim; ++i) maxAbs = std::max(maxAbs, std::fabs(v[i]));
+    if (maxAbs < 1e-12f) {
+        std::fill(out, out + dim, static_cast<int8_t>(0));
+        return 0.0f;
+    }
+    float inv = 127.0f / maxAbs;
+    for (size_t i = 0; i < dim; ++i) {
+        out[i] = static_cast<int8_t>(std::lround(v[i] * inv));
+    }
+    return maxAbs / 127.0f;
+}
+
+void QuantizedIndex::add(uint32_t row) {
+    if (row != size_) return;  // row harus di-add berurutan
+    const size_t dim = matrix_.dim();
+    const float* v = matrix_.row(row);
+
+    if (mode_ == StorageMode::Int8) {
+        if (codeStride_ == 0) codeStride_ = (dim + 63) / 64 * 64;
+        int8Codes_.resize((size_ + 1) * codeStride_, 0);
+        int8Scales_.push_back(quantizeInt8(v, dim, &int8Codes_[size_ * codeStride_]));
+    } else {
+        if (codeStride_ == 0) codeStride_ = (dim + 31) / 32 * 32;
+        fp16Codes_.resize((size_ + 1) * codeStride_, 0);
+        uint16_t* out = &fp16Codes_[size_ * codeStride_];
+        for (size_t i = 0; i < dim; ++i) out[i] = simd::floatToHalf(v[i]);
+    }
+    ++size_;
+}
+
+void QuantizedIndex::clear() {
+    size_ = 0;
+    int8Codes_.clear();
+    int8Scales_.clear();
+    fp16Codes_.clear();
+}
+
+size_t QuantizedIndex::memoryBytes() const {
+    return int8Codes_.size() * sizeof(int8_t) + int8Scales_.size() * sizeof(float) +
+           fp16Codes_.size() * sizeof(uint16_t);
+}
+
+float QuantizedIndex::approxScore(const float* query, uint32_t row) const {
+    const size_t dim = matrix_.dim();
+    if (mode_ == StorageMode::Int8) {
+        std::vector<int8_t> q(dim);
+        float qScale = quantizeInt8(query, dim, q.data());
+        return qScale * int8Scales_[row] *
+               static_cast<float>(simd::dotInt8(q.data(), &int8Codes_[row * codeStride_], dim));
+    }
+    return simd::dotFp16(query, &fp16Codes_[row * codeStride_], dim);
+}
+
+std::vector<SearchHit> QuantizedIndex::search(const float* query, size_t k) const {
+    if (k == 0 || size_ == 0) return {};
+    const size_t dim = matrix_.dim();
+
+    // Tahap 1: scan code, simpan kandidat sebanyak max(k, rerankK)
+    std::vector<SearchHit> coarse;
+    if (mode_ == StorageMode::Int8) {
+        std::vector<int8_t> q(dim);
+        float qScale = quantizeInt8(query, dim, q.data());
+        coarse = parallelTopK(size_, codeStride_, std::max(k, rerankK_), parallel_,
+                              [&](size_t begin, size_t end, TopK& top) {
+            for (size_t r = begin; r < end; ++r) {
+                int32_t raw = simd::dotInt8(q.data(), &int8Codes_[r * codeStride_], dim);
+                top.push(static_cast<uint32_t>(r), qScale * int8Scales_[r] * static_cast<float>(raw));
+            }
+        });
+    } else {
+        coarse = parallelTopK(size_, codeStride_ * sizeof(uint16_t), std::max(k, rerankK_), parallel_,
+                              [&](size_t begin, size_t end, TopK& top) {
+            for (size_t r = begin; r < end; ++r) {
+                top.push(static_cast<uint32_t>(r), simd::dotFp16(query, &fp16Codes_[r * codeStride_], dim));
+            }
+        });
+    }
+
+    // Tahap 2: re-rank dengan float penuh
+    TopK exact(k);
+    for (const SearchHit& hit : coarse) {
+        exact.push(hit.row, simd::dot(query, matrix_.row(hit.row), dim));
+    }
+    return exact.take();
+}
@@ -0,0 +1,49 @@
+#ifndef QUANTIZED_INDEX_HPP
+#define QUANTIZED_INDEX_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "face_index.hpp"
+
+enum class StorageMode {
+    Float,
+    Int8,   // per-vector scale, code = round(x / scale), |code| <= 127
+    Fp16,
+};
+
+StorageMode parseStorageMode(const std::string& name);
+const char* storageModeName(StorageMode mode);
+
+// Scan dua tahap: skor kasar dari code int8/fp16, lalu top rerankK kandidat
+// dihitung ulang dengan float dari EmbeddingMatrix.
+class QuantizedIndex : public FaceIndex {
+public:
+    QuantizedIndex(const EmbeddingMatrix& matrix, StorageMode mode, size_t rerankK);
+
+    const char* name() const override { return storageModeName(mode_); }
+    void add(uint32_t row) override;
+    void clear() override;
+    size_t size() const override { return size_; }
+    size_t memoryBytes() const override;
+    std::vector<SearchHit> search(const float* query, size_t k) const override;
+
+    // Skor tahap pertama saja (tanpa re-rank), untuk laporan akurasi
+    float approxScore(const float* query, uint32_t row) const;
+
+private:
+    const EmbeddingMatrix& matrix_;
+    StorageMode mode_;
+    size_t rerankK_;
+    size_t size_ = 0;
+    size_t codeStride_ = 0;   // elemen per row, di-pad ke 64 byte
+
+    std::vector<int8_t, AlignedAllocator<int8_t>> int8Codes_;
+    std::vector<float> int8Scales_;
+    std::vector<uint16_t, AlignedAllocator<uint16_t>> fp16Codes_;
+
+    static float quantizeInt8(const float* v, size_t dim, int8_t* out);
+};
+
+#endif
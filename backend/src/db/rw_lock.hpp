@@ -0,0 +1,37 @@
+#ifndef RW_LOCK_HPP
+#define RW_LOCK_HPP
+
+#include <pthread.h>
+#include <system_error>
+
+// Reader-writer lock yang mendahulukan writer. std::shared_mutex di glibc
+// mendahulukan reader, sehingga add() bisa tertahan selama ada aliran
+// find() tanpa jeda. Memenuhi SharedMutex: dipakai lewat std::shared_lock /
+// std::unique_lock. Reader tidak boleh mengunci ulang secara rekursif.
+class RwLock {
+public:
+    RwLock() {
+        pthread_rwlockattr_t attr;
+        pthread_rwlockattr_init(&attr);
+        pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+        int rc = pthread_rwlock_init(&lock_, &attr);
+        pthread_rwlockattr_destroy(&attr);
+        if (rc != 0) throw std::system_error(rc, std::generic_category(), "pthread_rwlock_init");
+    }
+    ~RwLock() { pthread_rwlock_destroy(&lock_); }
+    RwLock(const RwLock&) = delete;
+    RwLock& operator=(const RwLock&) = delete;
+
+    void lock() { pthread_rwlock_wrlock(&lock_); }
+    bool try_lock() { return pthread_rwlock_trywrlock(&lock_) == 0; }
+    void unlock() { pthread_rwlock_unlock(&lock_); }
+
+    void lock_shared() { pthread_rwlock_rdlock(&lock_); }
+    bool try_lock_shared() { return pthread_rwlock_tryrdlock(&lock_) == 0; }
+    void unlock_shared() { pthread_rwlock_unlock(&lock_); }
+
+private:
+    pthread_rwlock_t lock_;
+};
+
+#endif
@@ -0,0 +1,253 @@
+#include "simd_kernels.hpp"
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_X86 1
+#endif
+
+namespace simd {
+namespace {
+
+float dotScalar(const float* a, const float* b, size_t dim) {
+    // 4 accumulator supaya compiler tetap bisa vectorize tanpa -ffast-math
+    float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+    size_t i = 0;
+    for (; i + 4 <= dim; i += 4) {
+        s0 += a[i]     * b[i];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+    for (; i < dim; ++i) s0 += a[i] * b[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+int32_t dotInt8Scalar(const int8_t* a, const int8_t* b, size_t dim) {
+    int32_t sum = 0;
+    for (size_t i = 0; i < dim; ++i) sum += static_cast<int32_t>(a[i]) * b[i];
+    return sum;
+}
+
+float dotFp16Scalar(const float* q, const uint16_t* codes, size_t dim) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < dim; ++i) sum += q[i] * halfToFloat(codes[i]);
+    return sum;
+}
+
+#ifdef SIMD_X86
+__attribute__((target("avx2,fma")))
+float dotAvx2(const float* a, const float* b, size_t dim) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= dim; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i),     _mm256_loadu_ps(b + i),     acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+    }
+    for (; i + 8 <= dim; i += 8) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+    }
+    __m256 acc = _mm256_add_ps(acc0, acc1);
+    __m128 lo = _mm256_castps256_ps128(acc);
+    __m128 hi = _mm256_extractf128_ps(acc, 1);
+    lo = _mm_add_ps(lo, hi);
+    lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+    lo = _mm_add_ss(lo, _mm_shuffle_ps(lo, lo, 0x55));
+    float sum = _mm_cvtss_f32(lo);
+    for (; i < dim; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+__attribute__((target("avx512f")))
+float dotAvx512(const float* a, const float* b, size_t dim) {
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= dim; i += 32) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i),      _mm512_loadu_ps(b + i),      acc0);
+        acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), acc1);
+    }
+    for (; i + 16 <= dim; i += 16) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc0);
+    }
+    alignas(64) float lanes[16];
+    _mm512_store_ps(lanes, _mm512_add_ps(acc0, acc1));
+    float sum = 0.0f;
+    for (int k = 0; k < 16; ++k) sum += lanes[k];
+    for (; i < dim; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+// int8 -> int16 lalu madd: hasil pasangan dijumlah ke int32, tidak overflow
+// untuk dim <= 65536 karena |a*b| <= 127*127
+__attribute__((target("avx2")))
+int32_t dotInt8Avx2(const int8_t* a, const int8_t* b, size_t dim) {
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 16 <= dim; i += 16) {
+        __m256i va = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+        __m256i vb = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));
+    }
+    alignas(32) int32_t lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    int32_t sum = 0;
+    for (int k = 0; k < 8; ++k) sum += lanes[k];
+    for (; i < dim; ++i) sum += static_cast<int32_t>(a[i]) * b[i];
+    return sum;
+}
+
+__attribute__((target("avx512f,avx512bw")))
+int32_t dotInt8Avx512(const int8_t* a, const int8_t* b, size_t dim) {
+    __m512i acc = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 32 <= dim; i += 32) {
+        __m512i va = _mm512_cvtepi8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)));
+        __m512i vb = _mm512_cvtepi8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+        acc = _mm512_add_epi32(acc, _mm512_madd_epi16(va, vb));
+    }
+    alignas(64) int32_t lanes[16];
+    _mm512_store_si512(reinterpret_cast<__m512i*>(lanes), acc);
+    int32_t sum = 0;
+    for (int k = 0; k < 16; ++k) sum += lanes[k];
+    for (; i < dim; ++i) sum += static_cast<int32_t>(a[i]) * b[i];
+    return sum;
+}
+
+__attribute__((target("avx2,fma,f16c")))
+float dotFp16Avx2(const float* q, const uint16_t* codes, size_t dim) {
+    __m256 acc = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= dim; i += 8) {
+        __m256 vc = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(codes + i)));
+        acc = _mm256_fmadd_ps(_mm256_loadu_ps(q + i), vc, acc);
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, acc);
+    float sum = 0.0f;
+    for (int k = 0; k < 8; ++k) sum += lanes[k];
+    for (; i < dim; ++i) sum += q[i] * halfToFloat(codes[i]);
+    return sum;
+}
+#endif
+
+using DotFn = float (*)(const float*, const float*, size_t);
+using DotInt8Fn = int32_t (*)(const int8_t*, const int8_t*, size_t);
+using DotFp16Fn = float (*)(const float*, const uint16_t*, size_t);
+
+struct Dispatch {
+    DotFn dot;
+    DotInt8Fn dotInt8;
+    DotFp16Fn dotFp16;
+    const char* name;
+};
+
+Dispatch resolve() {
+    Dispatch d{dotScalar, dotInt8Scalar, dotFp16Scalar, "scalar"};
+#ifdef SIMD_X86
+    __builtin_cpu_init();
+    bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    if (avx2) {
+        d = {dotAvx2, dotInt8Avx2, dotFp16Scalar, "avx2"};
+        if (__builtin_cpu_supports("f16c")) d.dotFp16 = dotFp16Avx2;
+    }
+    if (__builtin_cpu_supports("avx512f")) {
+        d.dot = dotAvx512;
+        d.name = "avx512";
+        if (__builtin_cpu_supports("avx512bw")) d.dotInt8 = dotInt8Avx512;
+    }
+#endif
+    return d;
+}
+
+const Dispatch& dispatch() {
+    static const Dispatch d = resolve();
+    return d;
+}
+
+} // namespace
+
+float dot(const float* a, const float* b, size_t dim) {
+    return dispatch().dot(a, b, dim);
+}
+
+void dotBatch(const float* query, const float* matrix, size_t rows,
+              size_t stride, size_t dim, float* scores) {
+    DotFn fn = dispatch().dot;
+    for (size_t r = 0; r < rows; ++r) {
+        scores[r] = fn(query, matrix + r * stride, dim);
+    }
+}
+
+int32_t dotInt8(const int8_t* a, const int8_t* b, size_t dim) {
+    return dispatch().dotInt8(a, b, dim);
+}
+
+float dotFp16(const float* query, const uint16_t* codes, size_t dim) {
+    return dispatch().dotFp16(query, codes, dim);
+}
+
+// IEEE 754 binary16, round-to-nearest-even
+uint16_t floatToHalf(float v) {
+    uint32_t x;
+    std::memcpy(&x, &v, sizeof(x));
+    uint16_t sign = static_cast<uint16_t>((x >> 16) & 0x8000u);
+    uint32_t absx = x & 0x7fffffffu;
+
+    if (absx >= 0x7f800000u) {                       // Inf / NaN
+        return sign | 0x7c00u | (absx > 0x7f800000u ? 0x200u : 0u);
+    }
+    if (absx >= 0x477ff000u) return sign | 0x7c00u;  // overflow -> Inf
+    if (absx < 0x38800000u) {                        // subnormal / nol
+        if (absx < 0x33000000u) return sign;
+        uint32_t mant = (absx & 0x007fffffu) | 0x00800000u;
+        int shift = 126 - static_cast<int>(absx >> 23);
+        uint32_t half = mant >> shift;
+        uint32_t rem = mant & ((1u << shift) - 1);
+        uint32_t mid = 1u << (shift - 1);
+        if (rem > mid || (rem == mid && (half & 1u))) ++half;
+        return sign | static_cast<uint16_t>(half);
+    }
+    uint32_t half = ((absx - 0x38000000u) >> 13);
+    uint32_t rem = absx & 0x1fffu;
+    if (rem > 0x1000u || (rem == 0x1000u && (half & 1u))) ++half;
+    return sign | static_cast<uint16_t>(half);
+}
+
+float halfToFloat(uint16_t h) {
+    uint32_t sign = static_cast<uint32_t>(h & 0x8000u) << 16;
+    uint32_t exp = (h >> 10) & 0x1fu;
+    uint32_t mant = h & 0x3ffu;
+    uint32_t x;
+    if (exp == 0) {
+        if (mant == 0) {
+            x = sign;
+        } else {                                     // subnormal -> normal
+            int e = -1;
+            do { mant <<= 1; ++e; } while ((mant & 0x400u) == 0);
+            x = sign | static_cast<uint32_t>(112 - e) << 23 | (mant & 0x3ffu) << 13;
+        }
+    } else if (exp == 0x1fu) {
+        x = sign | 0x7f800000u | (mant << 13);
+    } else {
+        x = sign | (exp + 112) << 23 | (mant << 13);
+    }
+    float v;
+    std::memcpy(&v, &x, sizeof(v));
+    return v;
+}
+
+bool normalize(float* v, size_t dim) {
+    float norm = std::sqrt(dot(v, v, dim));
+    if (norm < 1e-8f) return false;
+    for (size_t i = 0; i < dim; ++i) v[i] /= norm;
+    return true;
+}
+
+const char* activeIsa() {
+    return dispatch().name;
+}
+
+} // namespace simd
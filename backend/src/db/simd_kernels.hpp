@@ -0,0 +1,32 @@
+#ifndef SIMD_KERNELS_HPP
+#define SIMD_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Dot-product kernels for the gallery scan. The best implementation
+// (AVX-512 / AVX2+FMA / scalar) is picked once at runtime from CPUID, so the
+// binary stays portable and no global -mavx flags are needed.
+namespace simd {
+
+float dot(const float* a, const float* b, size_t dim);
+
+// v /= |v|; false (v tidak diubah) bila norm ~ 0
+bool normalize(float* v, size_t dim);
+
+// scores[i] = dot(query, matrix + i * stride) untuk i in [0, rows)
+void dotBatch(const float* query, const float* matrix, size_t rows,
+              size_t stride, size_t dim, float* scores);
+
+// Kernel untuk storage terkuantisasi (lihat QuantizedIndex)
+int32_t dotInt8(const int8_t* a, const int8_t* b, size_t dim);
+float dotFp16(const float* query, const uint16_t* codes, size_t dim);
+
+uint16_t floatToHalf(float v);
+float halfToFloat(uint16_t h);
+
+const char* activeIsa();
+
+} // namespace simd
+
+#endif
@@ -0,0 +1,249 @@
+#include "write_ahead_log.hpp"
+#include "crc32.hpp"
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint32_t kRecordMagic = 0x52574c46;  // "FLWR"
+constexpr size_t kRecordHeader = 12;
+constexpr uint32_t kMaxPayload = 1u << 20;
+
+void put(std::vector<unsigned char>& out, const void* p, size_t n) {
+    const unsigned char* b = static_cast<const unsigned char*>(p);
+    out.insert(out.end(), b, b + n);
+}
+
+bool writeAll(int fd, const unsigned char* p, size_t len, uint64_t offset) {
+    while (len > 0) {
+        ssize_t n = ::pwrite(fd, p, len, static_cast<off_t>(offset));
+        if (n <= 0) return false;
+        p += n;
+        len -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+bool parsePayload(const unsigned char* p, size_t len, WalEntry& out) {
+    if (len < 16) return false;
+    uint64_t row;
+    uint16_t idLen, nameLen;
+    uint32_t dim;
+    std::memcpy(&row, p, 8);
+    std::memcpy(&idLen, p + 8, 2);
+    std::memcpy(&nameLen, p + 10, 2);
+    std::memcpy(&dim, p + 12, 4);
+    if (len != 16 + static_cast<size_t>(idLen) + nameLen + static_cast<size_t>(dim) * sizeof(float)) {
+        return false;
+    }
+    out.row = row;
+    out.id.assign(reinterpret_cast<const char*>(p + 16), idLen);
+    out.name.assign(reinterpret_cast<const char*>(p + 16 + idLen), nameLen);
+    out.embedding.resize(dim);
+    std::memcpy(out.embedding.data(), p + 16 + idLen + nameLen, dim * sizeof(float));
+    return true;
+}
+
+void encodeRecord(const WalEntry& entry, std::vector<unsigned char>& out) {
+    std::vector<unsigned char> payload;
+    payload.reserve(16 + entry.id.size() + entry.name.size() + entry.embedding.size() * sizeof(float));
+    uint16_t idLen = static_cast<uint16_t>(entry.id.size());
+    uint16_t nameLen = static_cast<uint16_t>(entry.name.size());
+    uint32_t dim = static_cast<uint32_t>(entry.embedding.size());
+    put(payload, &entry.row, 8);
+    put(payload, &idLen, 2);
+    put(payload, &nameLen, 2);
+    put(payload, &dim, 4);
+    put(payload, entry.id.data(), idLen);
+    put(payload, entry.name.data(), nameLen);
+    put(payload, entry.embedding.data(), dim * sizeof(float));
+
+    uint32_t len = static_cast<uint32_t>(payload.size());
+    uint32_t crc = crc32c(payload.data(), payload.size());
+    put(out, &kRecordMagic, 4);
+    put(out, &len, 4);
+    put(out, &crc, 4);
+    out.insert(out.end(), payload.begin(), payload.end());
+}
+
+} // namespace
+
+WriteAheadLog::~WriteAheadLog() {
+    close();
+}
+
+bool WriteAheadLog::open(const std::string& path, std::chrono::microseconds groupWindow) {
+    close();
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) return false;
+
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    path_ = path;
+    groupWindow_ = groupWindow;
+    fileBytes_ = static_cast<uint64_t>(st.st_size);
+    appendedLsn_ = durableLsn_ = 0;
+    failed_ = stopping_ = false;
+    pending_.clear();
+    flusher_ = std::thread(&WriteAheadLog::flushLoop, this);
+    return true;
+}
+
+void WriteAheadLog::close() {
+    if (flusher_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            stopping_ = true;
+        }
+        pendingCv_.notify_all();
+        flusher_.join();
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+size_t WriteAheadLog::replay(const std::function<bool(const WalEntry&)>& apply) {
+    if (fd_ < 0) return 0;
+    const uint64_t size = fileBytes_.load();
+    std::vector<unsigned char> data(size);
+    size_t got = 0;
+    while (got < size) {
+        ssize_t n = ::pread(fd_, data.data() + got, size - got, static_cast<off_t>(got));
+        if (n <= 0) break;
+        got += static_cast<size_t>(n);
+    }
+
+    size_t off = 0, applied = 0;
+    WalEntry entry;
+    while (off + kRecordHeader <= got) {
+        uint32_t magic, len, crc;
+        std::memcpy(&magic, &data[off], 4);
+        std::memcpy(&len, &data[off + 4], 4);
+        std::memcpy(&crc, &data[off + 8], 4);
+        if (magic != kRecordMagic || len > kMaxPayload || off + kRecordHeader + len > got) break;
+        const unsigned char* payload = &data[off + kRecordHeader];
+        if (crc32c(payload, len) != crc || !parsePayload(payload, len, entry)) break;
+        if (!apply(entry)) break;
+        off += kRecordHeader + len;
+        ++applied;
+    }
+
+    if (off < size) {
+        std::cerr << "[WAL] Discarding " << (size - off) << " bytes of torn/corrupt log after "
+                  << applied << " records: " << path_ << std::endl;
+        if (::ftruncate(fd_, static_cast<off_t>(off)) == 0) ::fdatasync(fd_);
+        fileBytes_ = off;
+    }
+    return applied;
+}
+
+uint64_t WriteAheadLog::append(const WalEntry& entry) {
+    std::vector<unsigned char> record;
+    encodeRecord(entry, record);
+
+    uint64_t lsn;
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        pending_.insert(pending_.end(), record.begin(), record.end());
+        lsn = ++appendedLsn_;
+    }
+    pendingCv_.notify_one();
+    return lsn;
+}
+
+uint64_t WriteAheadLog::appendBatch(const std::vector<WalEntry>& entries) {
+    if (entries.empty()) return 0;
+    std::vector<unsigned char> records;
+    for (const auto& entry : entries) encodeRecord(entry, records);
+
+    uint64_t lsn;
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        pending_.insert(pending_.end(), records.begin(), records.end());
+        appendedLsn_ += entries.size();
+        lsn = appendedLsn_;
+    }
+    pendingCv_.notify_one();
+    return lsn;
+}
+
+bool WriteAheadLog::waitDurable(uint64_t lsn) {
+    std::unique_lock<std::mutex> lk(mutex_);
+    durableCv_.wait(lk, [&] { return durableLsn_ >= lsn || failed_ || stopping_; });
+    return durableLsn_ >= lsn;
+}
+
+bool WriteAheadLog::flush() {
+    std::unique_lock<std::mutex> lk(mutex_);
+    durableCv_.wait(lk, [&] { return durableLsn_ >= appendedLsn_ || failed_ || stopping_; });
+    return durableLsn_ >= appendedLsn_;
+}
+
+uint64_t WriteAheadLog::durableLsn() {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return durableLsn_;
+}
+
+bool WriteAheadLog::reset() {
+    std::unique_lock<std::mutex> lk(mutex_);
+    // Tunggu flusher selesai supaya tidak ada write yang sedang berjalan
+    durableCv_.wait(lk, [&] { return (pending_.empty() && durableLsn_ == appendedLsn_) || failed_; });
+    if (failed_ || fd_ < 0) return false;
+    if (::ftruncate(fd_, 0) != 0 || ::fdatasync(fd_) != 0) return false;
+    fileBytes_ = 0;
+    return true;
+}
+
+void WriteAheadLog::flushLoop() {
+    std::unique_lock<std::mutex> lk(mutex_);
+    while (true) {
+        pendingCv_.wait(lk, [&] { return stopping_ || !pending_.empty(); });
+        if (pending_.empty()) break;  // stopping
+
+        // Group commit: beri waktu writer lain menumpang fsync yang sama
+        if (groupWindow_.count() > 0 && !stopping_) {
+            pendingCv_.wait_for(lk, groupWindow_, [&] { return stopping_; });
+        }
+
+        if (failed_) {
+            // Setelah gagal tidak ada lagi yang ditulis: LSN berikutnya tidak
+            // boleh dianggap durable melewati record yang hilang
+            pending_.clear();
+            durableCv_.notify_all();
+            continue;
+        }
+
+        std::vector<unsigned char> batch;
+        batch.swap(pending_);
+        uint64_t upto = appendedLsn_;
+        uint64_t offset = fileBytes_.load();
+        lk.unlock();
+
+        bool ok = writeAll(fd_, batch.data(), batch.size(), offset) && ::fdatasync(fd_) == 0;
+
+        lk.lock();
+        if (ok) {
+            fileBytes_ = offset + batch.size();
+            durableLsn_ = upto;
+        } else {
+            std::cerr << "[WAL] Write failed: " << path_ << std::endl;
+            // Potong batch yang mungkin sudah tertulis sebagian supaya tidak di-replay
+            if (::ftruncate(fd_, static_cast<off_t>(offset)) != 0) {
+                std::cerr << "[WAL] Cannot truncate failed batch: " << path_ << std::endl;
+            }
+            failed_ = true;
+        }
+        durableCv_.notify_all();
+    }
+}
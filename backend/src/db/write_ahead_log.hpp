@@ -0,0 +1,73 @@
+#ifndef WRITE_AHEAD_LOG_HPP
+#define WRITE_AHEAD_LOG_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct WalEntry {
+    uint64_t row = 0;               // posisi row di FaceStore, untuk replay idempotent
+    std::string id;
+    std::string name;
+    std::vector<float> embedding;
+};
+
+// Log append-only untuk registrasi. Tiap record: u32 magic, u32 panjang
+// payload, u32 crc32c(payload), payload. append() hanya menaruh record di
+// buffer; thread flusher menulis dan fdatasync beberapa record sekaligus
+// (group commit), lalu membangunkan semua waitDurable() yang tercakup.
+class WriteAheadLog {
+public:
+    WriteAheadLog() = default;
+    ~WriteAheadLog();
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    // groupWindow: waktu tunggu flusher untuk mengumpulkan record berikutnya
+    bool open(const std::string& path, std::chrono::microseconds groupWindow);
+    void close();
+    bool isOpen() const { return fd_ >= 0; }
+
+    // Membaca record valid dari awal file; berhenti di record rusak/terpotong
+    // dan memotong file di titik itu. Dipanggil sebelum append pertama.
+    size_t replay(const std::function<bool(const WalEntry&)>& apply);
+
+    uint64_t append(const WalEntry& entry);   // return LSN
+    // Semua entry masuk buffer sekaligus (satu fsync); return LSN entry terakhir
+    uint64_t appendBatch(const std::vector<WalEntry>& entries);
+    bool waitDurable(uint64_t lsn);
+    // Tunggu semua record yang sudah di-append durable; false bila log gagal
+    bool flush();
+    uint64_t durableLsn();
+
+    // Kosongkan log setelah isinya masuk snapshot (checkpoint)
+    bool reset();
+
+    uint64_t bytes() const { return fileBytes_.load(); }
+
+private:
+    std::string path_;
+    int fd_ = -1;
+    std::chrono::microseconds groupWindow_{0};
+
+    std::mutex mutex_;
+    std::condition_variable pendingCv_;
+    std::condition_variable durableCv_;
+    std::vector<unsigned char> pending_;
+    uint64_t appendedLsn_ = 0;
+    uint64_t durableLsn_ = 0;
+    bool failed_ = false;
+    bool stopping_ = false;
+    std::atomic<uint64_t> fileBytes_{0};
+    std::thread flusher_;
+
+    void flushLoop();
+};
+
+#endif
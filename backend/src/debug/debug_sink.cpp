@@ -0,0 +1,123 @@
+#include "debug_sink.hpp"
+#include "config/load_config.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+#include <sys/stat.h>
+
+DebugSinkOptions DebugSinkOptions::fromConfig(const Config& cfg) {
+    DebugSinkOptions o;
+    o.enabled = cfg.getInt("debug_enabled", 0) != 0;
+    o.sampleEvery = std::max(1, cfg.getInt("debug_sample_every", o.sampleEvery));
+    o.queueSize = static_cast<size_t>(std::max(1, cfg.getInt("debug_queue_size", static_cast<int>(o.queueSize))));
+    o.dir = cfg.getString("debug_dir", o.dir);
+    return o;
+}
+
+void DebugSink::start(const DebugSinkOptions& options) {
+    stop();
+    if (!options.enabled) return;
+
+    sampleEvery_ = std::max(1, options.sampleEvery);
+    dir_ = options.dir.empty() ? "." : options.dir;
+    ::mkdir(dir_.c_str(), 0755);
+    queue_.reset(new MpmcQueue<Item>(options.queueSize));
+    stopping_.store(false);
+    writer_ = std::thread(&DebugSink::writerLoop, this);
+    enabled_.store(true, std::memory_order_release);
+    printf("[Debug] Writing artifacts to %s (1 of %d requests)\n", dir_.c_str(), sampleEvery_);
+}
+
+void DebugSink::stop() {
+    enabled_.store(false, std::memory_order_release);
+    stopping_.store(true);
+    if (writer_.joinable()) writer_.join();
+}
+
+bool DebugSink::sample() {
+    if (!enabled()) return false;
+    return counter_.fetch_add(1, std::memory_order_relaxed) % sampleEvery_ == 0;
+}
+
+void DebugSink::image(const std::string& name, const cv::Mat& img) {
+    if (img.empty()) return;
+    Item item;
+    item.name = name;
+    item.image = img;  // refcount, gambar tidak diubah lagi oleh pipeline
+    push(std::move(item));
+}
+
+void DebugSink::render(const std::string& name, std::function<cv::Mat()> fn) {
+    Item item;
+    item.name = name;
+    item.render = std::move(fn);
+    push(std::move(item));
+}
+
+void DebugSink::text(const std::string& name, std::string content) {
+    Item item;
+    item.name = name;
+    item.text = std::move(content);
+    item.isText = true;
+    push(std::move(item));
+}
+
+void DebugSink::push(Item&& item) {
+    if (!enabled() || !queue_->tryPush(std::move(item))) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+DebugSink::Stats DebugSink::stats() const {
+    Stats s;
+    s.written = written_.load(std::memory_order_relaxed);
+    s.dropped = dropped_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void DebugSink::writerLoop() {
+    Item item;
+    for (;;) {
+        if (queue_->tryPop(item)) {
+            write(item);
+            item = Item();
+            continue;
+        }
+        if (stopping_.load()) {
+            // Producer yang sudah lolos cek enabled() sebelum stop masih bisa push
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            while (queue_->tryPop(item)) write(item);
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+}
+
+void DebugSink::write(Item& item) {
+    const std::string path = dir_ + "/" + item.name;
+    try {
+        bool ok;
+        if (item.isText) {
+            std::ofstream out(path);
+            out << item.text;
+            ok = static_cast<bool>(out);
+        } else {
+            cv::Mat img = item.render ? item.render() : item.image;
+            ok = !img.empty() && cv::imwrite(path, img);
+        }
+        if (ok) {
+            written_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            printf("[Debug] Failed to write %s\n", path.c_str());
+        }
+    } catch (const std::exception& e) {
+        printf("[Debug] Failed to write %s: %s\n", path.c_str(), e.what());
+    }
+}
+
+DebugSink& debugSink() {
+    static DebugSink sink;
+    return sink;
+}
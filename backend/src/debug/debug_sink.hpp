@@ -0,0 +1,86 @@
+#ifndef DEBUG_SINK_HPP
+#define DEBUG_SINK_HPP
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "util/mpmc_queue.hpp"
+
+class Config;
+
+struct DebugSinkOptions {
+    bool enabled = false;
+    int sampleEvery = 1;      // simpan artefak 1 dari N request
+    size_t queueSize = 64;    // item di luar kapasitas dibuang, request tidak menunggu
+    std::string dir = "/app/data/debug";
+
+    static DebugSinkOptions fromConfig(const Config& cfg);
+};
+
+// Artefak debug (gambar / teks) ditulis ke disk oleh satu thread latar
+// belakang. Request hanya memasukkan item ke antrian lock-free; encode JPEG,
+// render visualisasi dan file I/O terjadi di thread writer.
+//
+// Saat disabled, sample() / enabled() hanya satu load atomic dan tidak ada
+// thread writer.
+class DebugSink {
+public:
+    struct Stats {
+        uint64_t written = 0;
+        uint64_t dropped = 0;
+    };
+
+    DebugSink() = default;
+    ~DebugSink() { stop(); }
+    DebugSink(const DebugSink&) = delete;
+    DebugSink& operator=(const DebugSink&) = delete;
+
+    void start(const DebugSinkOptions& options);
+    // Item yang masih antre tetap ditulis sebelum thread berhenti
+    void stop();
+
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+    // Dipanggil sekali per request: true bila artefak request ini disimpan
+    bool sample();
+
+    // name relatif terhadap dir; ekstensi menentukan format (imwrite)
+    void image(const std::string& name, const cv::Mat& img);
+    // render dijalankan di thread writer (mis. colormap depth), bukan di request
+    void render(const std::string& name, std::function<cv::Mat()> fn);
+    void text(const std::string& name, std::string content);
+
+    Stats stats() const;
+
+private:
+    struct Item {
+        std::string name;
+        cv::Mat image;
+        std::function<cv::Mat()> render;
+        std::string text;
+        bool isText = false;
+    };
+
+    void push(Item&& item);
+    void writerLoop();
+    void write(Item& item);
+
+    std::atomic<bool> enabled_{false};
+    std::atomic<bool> stopping_{false};
+    std::atomic<uint64_t> counter_{0};
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> dropped_{0};
+    int sampleEvery_ = 1;
+    std::string dir_;
+    std::unique_ptr<MpmcQueue<Item>> queue_;
+    std::thread writer_;
+};
+
+// Satu sink untuk seluruh proses (dipakai server dan model)
+DebugSink& debugSink();
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef DETECTOR_BACKEND_HPP
+#define DETECTOR_BACKEND_HPP
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+struct FaceDetection {
+    cv::Rect box;
+    float score = 1.0f;
+    // 5 titik dalam koordinat gambar: mata kiri, mata kanan, hidung, mulut kiri,
+    // mulut kanan (kiri/kanan menurut gambar, urutan sama dengan template ArcFace).
+    // Kosong untuk detector tanpa landmark (Haar).
+    std::vector<cv::Point2f> landmarks;
+
+    bool hasLandmarks() const { return landmarks.size() == 5; }
+};
+
+// Implementasi detector yang bisa dipasang di belakang FaceDetector.
+// Satu instance tidak thread-safe (dipakai lewat ModelPool).
+class DetectorBackend {
+public:
+    virtual ~DetectorBackend() = default;
+
+    virtual const char* name() const = 0;
+    // image BGR; box hasil di-clip ke batas gambar
+    virtual std::vector<FaceDetection> detect(const cv::Mat& image) = 0;
+};
+
+#endif
@@ -1,52 +1,92 @@
 #include "face_detector.hpp"
+#include "config/load_config.hpp"
 #include <iostream>
 
-FaceDetector::FaceDetector() : isLoaded(false) {}
+DetectorOptions DetectorOptions::fromConfig(const Config& cfg) {
+    DetectorOptions o;
+    o.backend = cfg.getString("face_detector", o.backend);
+    o.modelPath = cfg.getString("face_detector_model");
+    o.cascadePath = cfg.getString("face_detection_model");
+    o.yunet.maxSide = cfg.getInt("detector_max_side", o.yunet.maxSide);
+    o.yunet.scoreThreshold = cfg.getFloat("detector_score_threshold", o.yunet.scoreThreshold);
+    o.yunet.nmsThreshold = cfg.getFloat("detector_nms_threshold", o.yunet.nmsThreshold);
+    o.haarFallback = cfg.getInt("detector_haar_fallback", 0) != 0;
+    return o;
+}
+
+FaceDetector::FaceDetector() {}
 
 FaceDetector::FaceDetector(const std::string& cascadePath) {
     loadCascade(cascadePath);
 }
 
 bool FaceDetector::loadCascade(const std::string& cascadePath) {
-    isLoaded = faceCascade.load(cascadePath);
-    if (!isLoaded) {
-        std::cerr << "Error loading cascade classifier from: " << cascadePath << std::endl;
-    }
-    return isLoaded;
+    auto haar = std::make_unique<HaarDetector>();
+    bool loaded = haar->load(cascadePath);
+    primary_ = loaded ? std::move(haar) : nullptr;
+    fallback_.reset();
+    return loaded;
 }
 
-std::vector<cv::Rect> FaceDetector::detectFaces(const cv::Mat& image){
-    std::vector<cv::Rect> faces;
-    if (!isLoaded || image.empty()) {
-        return faces;
+bool FaceDetector::load(const DetectorOptions& options) {
+    if (options.backend != "yunet") {
+        if (options.backend != "haar") {
+            std::cerr << "Unknown face_detector '" << options.backend << "', using haar" << std::endl;
+        }
+        return loadCascade(options.cascadePath);
     }
 
-    cv::Mat gray;
-    if (image.channels() == 3) {
-        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
-    } else {
-        gray = image.clone();
+    auto haar = std::make_unique<HaarDetector>();
+    bool haarLoaded = options.haarFallback && !options.cascadePath.empty() && haar->load(options.cascadePath);
+    auto yunet = std::make_unique<YuNetDetector>();
+    if (!options.modelPath.empty() && yunet->load(options.modelPath, options.yunet)) {
+        primary_ = std::move(yunet);
+        if (haarLoaded) fallback_ = std::move(haar);
+        return true;
     }
+    // Tanpa model YuNet, Haar tetap dimuat walau fallback dimatikan (perilaku lama)
+    if (!haarLoaded && (options.cascadePath.empty() || !haar->load(options.cascadePath))) return false;
+    std::cerr << "Face detector model unavailable, falling back to Haar cascade" << std::endl;
+    primary_ = std::move(haar);
+    fallback_.reset();
+    return true;
+}
 
-    // Deteksi wajah dengan parameter default
-    faceCascade.detectMultiScale(gray, faces, 1.1, 3, 0, cv::Size(30, 30));
+std::vector<FaceDetection> FaceDetector::detect(const cv::Mat& image) {
+    if (!primary_ || image.empty()) {
+        return {};
+    }
+    std::vector<FaceDetection> faces = primary_->detect(image);
+    if (faces.empty() && fallback_) {
+        faces = fallback_->detect(image);
+    }
     return faces;
 }
 
-cv::Rect FaceDetector::getLargestFace(const cv::Mat& image){
-    auto faces = detectFaces(image);
+std::vector<cv::Rect> FaceDetector::detectFaces(const cv::Mat& image){
+    std::vector<cv::Rect> rects;
+    for (const auto& face : detect(image)) rects.push_back(face.box);
+    return rects;
+}
+
+FaceDetection FaceDetector::getLargestDetection(const cv::Mat& image){
+    auto faces = detect(image);
     if (faces.empty()) {
-        return cv::Rect();
+        return FaceDetection();
     }
 
     // Cari wajah terbesar (berdasarkan area)
     auto largest = std::max_element(faces.begin(), faces.end(),
-        [](const cv::Rect& a, const cv::Rect& b) {
-            return a.area() < b.area();
+        [](const FaceDetection& a, const FaceDetection& b) {
+            return a.box.area() < b.box.area();
         });
     return *largest;
 }
 
+cv::Rect FaceDetector::getLargestFace(const cv::Mat& image){
+    return getLargestDetection(image).box;
+}
+
 cv::Mat FaceDetector::cropLargestFace(const cv::Mat& image){
     cv::Rect faceRect = getLargestFace(image);
     if (faceRect.empty()) {
@@ -55,13 +95,10 @@ cv::Mat FaceDetector::cropLargestFace(const cv::Mat& image){
     return image(faceRect).clone();
 }
 
-void FaceDetector::cropFace(const cv::Mat& image, cv::Mat& outCropped, cv::Mat& outSpoofness, cv::Rect& outRect) {
-    cv::Rect faceRect = getLargestFace(image);
-    if (faceRect.empty()) {
-        return;
-    }
-
-    faceRect = faceRect & cv::Rect(0, 0, image.cols, image.rows);
+void FaceDetector::cropFace(const cv::Mat& image, cv::Mat& outCropped, cv::Mat& outSpoofness, cv::Rect& outRect,
+                            std::vector<cv::Point2f>* outLandmarks) {
+    FaceDetection face = getLargestDetection(image);
+    cv::Rect faceRect = face.box & cv::Rect(0, 0, image.cols, image.rows);
     if (faceRect.empty()) {
         return;
     }
@@ -69,6 +106,9 @@ void FaceDetector::cropFace(const cv::Mat& image, cv::Mat& outCropped, cv::Mat&
     outCropped = image(faceRect).clone();
 
     outRect = faceRect;
+    if (outLandmarks) {
+        *outLandmarks = face.landmarks;
+    }
 
     int dw = faceRect.width * 0.25;
     int dh = faceRect.height * 0.25;
@@ -82,4 +122,4 @@ void FaceDetector::cropFace(const cv::Mat& image, cv::Mat& outCropped, cv::Mat&
     spoofRect = spoofRect & cv::Rect(0, 0, image.cols, image.rows);
 
     outSpoofness = image(spoofRect).clone();
-}
\ No newline at end of file
+}
@@ -2,10 +2,28 @@
 #define FACEDETECTOR_HPP
 
 #include <opencv2/opencv.hpp>
-#include <opencv2/objdetect.hpp>
+#include <memory>
 #include <vector>
 #include <string>
 
+#include "detector_backend.hpp"
+#include "haar_detector.hpp"
+#include "yunet_detector.hpp"
+
+class Config;
+
+struct DetectorOptions {
+    std::string backend = "haar";    // "haar" (default, geometri box galeri lama) | "yunet" (CNN + landmark)
+    std::string modelPath;           // model ONNX YuNet
+    std::string cascadePath;         // Haar cascade: backend "haar" atau fallback
+    YuNetParams yunet;
+    bool haarFallback = false;       // Haar dicoba bila CNN tidak menemukan wajah (box campuran di galeri)
+
+    static DetectorOptions fromConfig(const Config& cfg);
+};
+
+// Facade di atas DetectorBackend. Bila model CNN gagal dimuat, Haar dipakai
+// sebagai backend utama (perilaku lama).
 class FaceDetector {
 public:
     FaceDetector();
@@ -13,14 +31,21 @@ public:
     ~FaceDetector() = default;
 
     bool loadCascade(const std::string& cascadePath);
+    bool load(const DetectorOptions& options);
+    const char* backendName() const { return primary_ ? primary_->name() : "none"; }
+
+    std::vector<FaceDetection> detect(const cv::Mat& image);
     std::vector<cv::Rect> detectFaces(const cv::Mat& image);
+    // box kosong bila tidak ada wajah
+    FaceDetection getLargestDetection(const cv::Mat& image);
     cv::Rect getLargestFace(const cv::Mat& image);
     cv::Mat cropLargestFace(const cv::Mat& image);
-    void cropFace(const cv::Mat& image, cv::Mat& outCropped, cv::Mat& outSpoofness, cv::Rect& outRect);
+    void cropFace(const cv::Mat& image, cv::Mat& outCropped, cv::Mat& outSpoofness, cv::Rect& outRect,
+                  std::vector<cv::Point2f>* outLandmarks = nullptr);
 
 private:
-    cv::CascadeClassifier faceCascade;
-    bool isLoaded;
+    std::unique_ptr<DetectorBackend> primary_;
+    std::unique_ptr<HaarDetector> fallback_;
 };
 
-#endif // FACEDETECTOR_HPP
\ No newline at end of file
+#endif // FACEDETECTOR_HPP
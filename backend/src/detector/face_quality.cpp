@@ -0,0 +1,144 @@
+#include "face_quality.hpp"
+#include "config/load_config.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+
+const char* qualityGateName(QualityGate gate) {
+    switch (gate) {
+        case QualityGate::FaceSize: return "quality_size";
+        case QualityGate::Pose:     return "quality_pose";
+        case QualityGate::Exposure: return "quality_exposure";
+        case QualityGate::Blur:     return "quality_blur";
+    }
+    return "quality";
+}
+
+QualityParams QualityParams::fromConfig(const Config& cfg) {
+    QualityParams p;
+    if (cfg.has("quality_gates")) {
+        p.gates.clear();
+        std::stringstream ss(cfg.getString("quality_gates"));
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            item.erase(std::remove_if(item.begin(), item.end(), ::isspace), item.end());
+            if (item == "size") p.gates.push_back(QualityGate::FaceSize);
+            else if (item == "pose") p.gates.push_back(QualityGate::Pose);
+            else if (item == "exposure") p.gates.push_back(QualityGate::Exposure);
+            else if (item == "blur") p.gates.push_back(QualityGate::Blur);
+            else if (!item.empty() && item != "none") printf("[Quality] Unknown gate '%s' ignored\n", item.c_str());
+        }
+    }
+    p.minFaceSize = cfg.getInt("quality_min_face", p.minFaceSize);
+    p.maxYaw = cfg.getFloat("quality_max_yaw", p.maxYaw);
+    p.maxRollDeg = cfg.getFloat("quality_max_roll", p.maxRollDeg);
+    p.minBrightness = cfg.getFloat("quality_min_brightness", p.minBrightness);
+    p.maxBrightness = cfg.getFloat("quality_max_brightness", p.maxBrightness);
+    p.minSharpness = cfg.getFloat("quality_min_sharpness", p.minSharpness);
+    return p;
+}
+
+std::string QualityResult::reason() const {
+    char buf[96];
+    switch (gate) {
+        case QualityGate::FaceSize: std::snprintf(buf, sizeof(buf), "Face too small (%.0f px)", value); break;
+        case QualityGate::Pose:     std::snprintf(buf, sizeof(buf), "Face not frontal (%.2f)", value); break;
+        case QualityGate::Exposure: std::snprintf(buf, sizeof(buf), "Bad exposure (brightness %.0f)", value); break;
+        case QualityGate::Blur:     std::snprintf(buf, sizeof(buf), "Face too blurry (sharpness %.1f)", value); break;
+    }
+    return buf;
+}
+
+// Exposure dan blur berbagi satu patch: resize sekali, skala tetap sehingga
+// varians Laplacian tidak bergantung pada ukuran wajah di frame
+static const cv::Mat& grayPatch(const cv::Mat& frame, const cv::Rect& face, cv::Mat& gray) {
+    if (gray.empty()) {
+        cv::Mat patch;
+        cv::resize(frame(face), patch, cv::Size(112, 112), 0, 0, cv::INTER_AREA);
+        if (patch.channels() == 3) {
+            cv::cvtColor(patch, gray, cv::COLOR_BGR2GRAY);
+        } else {
+            gray = patch;
+        }
+    }
+    return gray;
+}
+
+// yaw = |hidung - tengah mata| / jarak mata, roll = kemiringan garis mata (derajat)
+static bool measurePose(const std::vector<cv::Point2f>& landmarks, float& yaw, float& rollDeg) {
+    if (landmarks.size() < 3) return false;
+    cv::Point2f eyeL = landmarks[0], eyeR = landmarks[1], nose = landmarks[2];
+    float eyeDist = std::hypot(eyeR.x - eyeL.x, eyeR.y - eyeL.y);
+    if (eyeDist < 1.0f) return false;
+    yaw = std::fabs(nose.x - 0.5f * (eyeL.x + eyeR.x)) / eyeDist;
+    rollDeg = std::fabs(std::atan2(eyeR.y - eyeL.y, eyeR.x - eyeL.x)) * 180.0f / static_cast<float>(CV_PI);
+    return true;
+}
+
+static float sharpnessOf(const cv::Mat& gray) {
+    cv::Mat laplacian;
+    cv::Laplacian(gray, laplacian, CV_32F);
+    cv::Scalar mean, stddev;
+    cv::meanStdDev(laplacian, mean, stddev);
+    return static_cast<float>(stddev[0] * stddev[0]);
+}
+
+QualityMetrics FaceQualityGate::measure(const cv::Mat& frame, const cv::Rect& face,
+                                        const std::vector<cv::Point2f>& landmarks) {
+    QualityMetrics m;
+    cv::Rect box = face & cv::Rect(0, 0, frame.cols, frame.rows);
+    m.faceSize = static_cast<float>(std::min(box.width, box.height));
+    measurePose(landmarks, m.yaw, m.rollDeg);
+    if (!box.empty()) {
+        cv::Mat gray;
+        m.brightness = static_cast<float>(cv::mean(grayPatch(frame, box, gray))[0]);
+        m.sharpness = sharpnessOf(gray);
+    }
+    return m;
+}
+
+QualityResult FaceQualityGate::check(const cv::Mat& frame, const cv::Rect& face,
+                                     const std::vector<cv::Point2f>& landmarks) const {
+    QualityResult result;
+    cv::Mat gray;
+    cv::Rect box = face & cv::Rect(0, 0, frame.cols, frame.rows);
+
+    for (QualityGate gate : params_.gates) {
+        result.gate = gate;
+        switch (gate) {
+            case QualityGate::FaceSize:
+                result.value = static_cast<float>(std::min(box.width, box.height));
+                result.ok = result.value >= params_.minFaceSize;
+                break;
+            case QualityGate::Pose: {
+                // Tanpa landmark (Haar) pose tidak bisa diukur: lolos
+                float yaw, roll;
+                if (!measurePose(landmarks, yaw, roll)) break;
+                result.value = yaw;
+                result.ok = yaw <= params_.maxYaw;
+                if (result.ok && roll > params_.maxRollDeg) {
+                    result.value = roll;
+                    result.ok = false;
+                }
+                break;
+            }
+            case QualityGate::Exposure: {
+                if (box.empty()) break;
+                result.value = static_cast<float>(cv::mean(grayPatch(frame, box, gray))[0]);
+                result.ok = result.value >= params_.minBrightness && result.value <= params_.maxBrightness;
+                break;
+            }
+            case QualityGate::Blur: {
+                if (box.empty()) break;
+                result.value = sharpnessOf(grayPatch(frame, box, gray));
+                result.ok = result.value >= params_.minSharpness;
+                break;
+            }
+        }
+        if (!result.ok) return result;
+    }
+    result.ok = true;
+    return result;
+}
@@ -0,0 +1,64 @@
+#ifndef FACE_QUALITY_HPP
+#define FACE_QUALITY_HPP
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+class Config;
+
+enum class QualityGate { FaceSize, Pose, Exposure, Blur };
+
+const char* qualityGateName(QualityGate gate);  // "quality_size", "quality_pose", ...
+
+struct QualityParams {
+    // Urutan = urutan eksekusi; gate yang tidak tercantum dilewati. Default kosong:
+    // threshold di bawah belum dikalibrasi, aktifkan setelah `bench quality` pada
+    // frame yang selama ini diterima. Urutan termurah: ukuran box dan pose
+    // (aritmetika landmark), lalu exposure dan blur di atas satu patch abu-abu 112x112
+    std::vector<QualityGate> gates;
+    int minFaceSize = 60;          // sisi terpendek box (px)
+    float maxYaw = 0.6f;           // |hidung - tengah mata| / jarak mata
+    float maxRollDeg = 30.0f;      // kemiringan garis mata
+    float minBrightness = 40.0f;   // rata-rata gray patch wajah
+    float maxBrightness = 220.0f;
+    float minSharpness = 30.0f;    // varians Laplacian patch wajah
+
+    // quality_gates = size,pose,exposure,blur (kosong / none = nonaktif)
+    static QualityParams fromConfig(const Config& cfg);
+};
+
+// Semua metrik sekaligus (tanpa short-circuit), untuk kalibrasi threshold
+struct QualityMetrics {
+    float faceSize = 0.0f;
+    float yaw = -1.0f;             // -1: tanpa landmark (Haar)
+    float rollDeg = -1.0f;
+    float brightness = 0.0f;
+    float sharpness = 0.0f;
+};
+
+struct QualityResult {
+    bool ok = true;
+    QualityGate gate = QualityGate::FaceSize;  // gate yang menolak (bila !ok)
+    float value = 0.0f;                        // nilai terukur pada gate itu
+    std::string reason() const;
+};
+
+// Pre-filter murah sebelum depth + embedding: frame buruk ditolak dalam
+// mikrodetik, bukan setelah ratusan ms inferensi. check() const, aman dipakai
+// paralel dari banyak request.
+class FaceQualityGate {
+public:
+    explicit FaceQualityGate(const QualityParams& params = QualityParams()) : params_(params) {}
+
+    bool enabled() const { return !params_.gates.empty(); }
+    const QualityParams& params() const { return params_; }
+    QualityResult check(const cv::Mat& frame, const cv::Rect& face, const std::vector<cv::Point2f>& landmarks) const;
+    static QualityMetrics measure(const cv::Mat& frame, const cv::Rect& face,
+                                  const std::vector<cv::Point2f>& landmarks);
+
+private:
+    QualityParams params_;
+};
+
+#endif
@@ -0,0 +1,35 @@
+#include "face_tracker.hpp"
+
+FaceTracker::FaceTracker(const TrackerParams& params) : params_(params) {}
+
+float FaceTracker::iou(const cv::Rect& a, const cv::Rect& b) {
+    float inter = static_cast<float>((a & b).area());
+    float uni = static_cast<float>(a.area() + b.area()) - inter;
+    return uni > 0.0f ? inter / uni : 0.0f;
+}
+
+bool FaceTracker::update(const cv::Rect& box) {
+    bool continued = active_ && iou(box_, box) >= params_.minIou;
+    if (!continued) {
+        active_ = true;
+        ++trackId_;
+        age_ = 0;
+    }
+    box_ = box;
+    missed_ = 0;
+    ++age_;
+    return continued;
+}
+
+void FaceTracker::miss() {
+    if (active_ && ++missed_ > params_.maxMissed) {
+        reset();
+    }
+}
+
+void FaceTracker::reset() {
+    active_ = false;
+    age_ = 0;
+    missed_ = 0;
+    box_ = cv::Rect();
+}
@@ -0,0 +1,41 @@
+#ifndef FACE_TRACKER_HPP
+#define FACE_TRACKER_HPP
+
+#include <opencv2/opencv.hpp>
+
+struct TrackerParams {
+    float minIou = 0.3f;   // IoU minimum box frame berikutnya agar dianggap wajah yang sama
+    int maxMissed = 2;     // frame berturut-turut tanpa wajah sebelum track putus
+};
+
+// Tracker satu wajah berbasis IoU antar deteksi berurutan (stream kiosk: satu
+// orang di depan kamera). Murah: tidak ada model tambahan, hanya box detector.
+// Track baru (id baru) dimulai bila IoU turun di bawah minIou atau wajah hilang
+// lebih dari maxMissed frame. Tidak thread-safe.
+class FaceTracker {
+public:
+    explicit FaceTracker(const TrackerParams& params = TrackerParams());
+
+    // true bila box melanjutkan track aktif, false bila track baru dimulai
+    bool update(const cv::Rect& box);
+    // frame tanpa wajah; track putus setelah maxMissed frame
+    void miss();
+    void reset();
+
+    bool active() const { return active_; }
+    int trackId() const { return trackId_; }
+    const cv::Rect& box() const { return box_; }
+    int age() const { return age_; }  // jumlah frame dalam track aktif
+
+    static float iou(const cv::Rect& a, const cv::Rect& b);
+
+private:
+    TrackerParams params_;
+    bool active_ = false;
+    int trackId_ = 0;
+    int age_ = 0;
+    int missed_ = 0;
+    cv::Rect box_;
+};
+
+#endif
@@ -0,0 +1,35 @@
+#include "haar_detector.hpp"
+#include <iostream>
+
+bool HaarDetector::load(const std::string& cascadePath) {
+    loaded_ = cascade_.load(cascadePath);
+    if (!loaded_) {
+        std::cerr << "Error loading cascade classifier from: " << cascadePath << std::endl;
+    }
+    return loaded_;
+}
+
+std::vector<FaceDetection> HaarDetector::detect(const cv::Mat& image) {
+    std::vector<FaceDetection> out;
+    if (!loaded_ || image.empty()) {
+        return out;
+    }
+
+    cv::Mat gray;
+    if (image.channels() == 3) {
+        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+    } else {
+        gray = image;
+    }
+
+    // Deteksi wajah dengan parameter default
+    std::vector<cv::Rect> faces;
+    cascade_.detectMultiScale(gray, faces, 1.1, 3, 0, cv::Size(30, 30));
+    const cv::Rect bounds(0, 0, image.cols, image.rows);
+    for (const auto& face : faces) {
+        FaceDetection det;
+        det.box = face & bounds;
+        if (!det.box.empty()) out.push_back(det);
+    }
+    return out;
+}
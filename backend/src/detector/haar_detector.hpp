@@ -0,0 +1,22 @@
+#ifndef HAAR_DETECTOR_HPP
+#define HAAR_DETECTOR_HPP
+
+#include <opencv2/objdetect.hpp>
+#include <string>
+
+#include "detector_backend.hpp"
+
+// Haar cascade pada frame resolusi penuh (perilaku lama), tanpa landmark
+class HaarDetector : public DetectorBackend {
+public:
+    bool load(const std::string& cascadePath);
+
+    const char* name() const override { return "haar"; }
+    std::vector<FaceDetection> detect(const cv::Mat& image) override;
+
+private:
+    cv::CascadeClassifier cascade_;
+    bool loaded_ = false;
+};
+
+#endif
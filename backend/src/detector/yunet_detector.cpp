@@ -0,0 +1,55 @@
+#include "yunet_detector.hpp"
+#include <algorithm>
+#include <iostream>
+
+bool YuNetDetector::load(const std::string& modelPath, const YuNetParams& params) {
+    params_ = params;
+    inputSize_ = cv::Size(params.maxSide, params.maxSide);
+    try {
+        net_ = cv::FaceDetectorYN::create(modelPath, "", inputSize_, params.scoreThreshold,
+                                          params.nmsThreshold, params.topK);
+    } catch (const cv::Exception& e) {
+        std::cerr << "Error loading face detector model from: " << modelPath << " (" << e.what() << ")" << std::endl;
+        net_.release();
+    }
+    return !net_.empty();
+}
+
+std::vector<FaceDetection> YuNetDetector::detect(const cv::Mat& image) {
+    std::vector<FaceDetection> out;
+    if (net_.empty() || image.empty() || image.channels() != 3) {
+        return out;
+    }
+
+    // Sisi terpanjang diperkecil ke maxSide; frame kecil tidak diperbesar
+    float scale = std::min(1.0f, static_cast<float>(params_.maxSide) / std::max(image.cols, image.rows));
+    const cv::Mat* input = &image;
+    if (scale < 1.0f) {
+        cv::resize(image, resized_, cv::Size(), scale, scale, cv::INTER_AREA);
+        input = &resized_;
+    }
+    if (input->size() != inputSize_) {
+        inputSize_ = input->size();
+        net_->setInputSize(inputSize_);
+    }
+    net_->detect(*input, faces_);
+
+    // Tiap baris: x, y, w, h, 5 x (x, y) landmark, score
+    const cv::Rect bounds(0, 0, image.cols, image.rows);
+    const float inv = 1.0f / scale;
+    for (int i = 0; i < faces_.rows; ++i) {
+        const float* f = faces_.ptr<float>(i);
+        FaceDetection det;
+        int x0 = cvRound(f[0] * inv), y0 = cvRound(f[1] * inv);
+        int x1 = cvRound((f[0] + f[2]) * inv), y1 = cvRound((f[1] + f[3]) * inv);
+        det.box = cv::Rect(x0, y0, x1 - x0, y1 - y0) & bounds;
+        if (det.box.empty()) continue;
+        det.score = f[14];
+        det.landmarks.reserve(5);
+        for (int p = 0; p < 5; ++p) {
+            det.landmarks.emplace_back(f[4 + 2 * p] * inv, f[5 + 2 * p] * inv);
+        }
+        out.push_back(std::move(det));
+    }
+    return out;
+}
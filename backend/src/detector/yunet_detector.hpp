@@ -0,0 +1,33 @@
+#ifndef YUNET_DETECTOR_HPP
+#define YUNET_DETECTOR_HPP
+
+#include <opencv2/objdetect.hpp>
+#include <string>
+
+#include "detector_backend.hpp"
+
+struct YuNetParams {
+    int maxSide = 320;            // frame diperkecil hingga sisi terpanjang <= maxSide
+    float scoreThreshold = 0.7f;
+    float nmsThreshold = 0.3f;
+    int topK = 50;
+};
+
+// Detector CNN ringan (YuNet, ONNX lewat cv::FaceDetectorYN): box + 5 landmark.
+// Inferensi pada frame yang diperkecil, hasil diskalakan kembali ke frame asli.
+class YuNetDetector : public DetectorBackend {
+public:
+    bool load(const std::string& modelPath, const YuNetParams& params = YuNetParams());
+
+    const char* name() const override { return "yunet"; }
+    std::vector<FaceDetection> detect(const cv::Mat& image) override;
+
+private:
+    cv::Ptr<cv::FaceDetectorYN> net_;
+    YuNetParams params_;
+    cv::Size inputSize_;
+    cv::Mat resized_;   // buffer dipakai ulang antar frame
+    cv::Mat faces_;
+};
+
+#endif
@@ -0,0 +1,120 @@
+#include "embedder/embedding_cache.hpp"
+#include "embedder/face_alignment.hpp"
+#include "config/load_config.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+EmbeddingCacheOptions EmbeddingCacheOptions::fromConfig(const Config& cfg, bool aligned) {
+    EmbeddingCacheOptions o;
+    o.capacity = static_cast<size_t>(std::max(0, cfg.getInt("embed_cache_size", 0)));
+    o.ttlSec = std::max(1, cfg.getInt("embed_cache_ttl_sec", o.ttlSec));
+    o.maxHamming = std::max(0, cfg.getInt("embed_cache_max_hamming", o.maxHamming));
+    o.maxPixelDiff = cfg.getFloat("embed_cache_max_pixel_diff", o.maxPixelDiff);
+    o.aligned = aligned;
+    return o;
+}
+
+EmbeddingCache::EmbeddingCache(const EmbeddingCacheOptions& options) : options_(options) {}
+
+void EmbeddingCache::configure(const EmbeddingCacheOptions& options) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    options_ = options;
+    lru_.clear();
+    stats_ = Stats();
+}
+
+FaceFingerprint EmbeddingCache::fingerprint(const FaceInput& face) const {
+    FaceFingerprint key;
+    if (face.image.empty()) return key;
+
+    // Crop yang sama dengan input embedder, diperkecil; warp ke 32x32 lalu
+    // INTER_AREA ke 16x16 supaya jitter landmark / box kecil tidak mengubah hash
+    cv::Mat small;
+    if (options_.aligned && face.landmarks.size() == 5) {
+        small = alignFace(face.image, face.landmarks, cv::Size(32, 32));
+    } else {
+        cv::Rect box = face.box.empty() ? cv::Rect(0, 0, face.image.cols, face.image.rows) : face.box;
+        box &= cv::Rect(0, 0, face.image.cols, face.image.rows);
+        if (box.empty()) return key;
+        small = face.image(box);
+    }
+    if (small.empty()) return key;
+
+    cv::Mat gray, thumb, hashGrid;
+    if (small.channels() == 3) {
+        cv::cvtColor(small, gray, cv::COLOR_BGR2GRAY);
+    } else {
+        gray = small;
+    }
+    cv::resize(gray, thumb, cv::Size(16, 16), 0, 0, cv::INTER_AREA);
+    cv::resize(thumb, hashGrid, cv::Size(9, 8), 0, 0, cv::INTER_AREA);
+
+    // dHash: bit = piksel lebih terang dari tetangga kanan, 8 baris x 8 bit
+    for (int y = 0; y < 8; ++y) {
+        const uint8_t* row = hashGrid.ptr<uint8_t>(y);
+        for (int x = 0; x < 8; ++x) {
+            key.hash = (key.hash << 1) | (row[x] > row[x + 1] ? 1u : 0u);
+        }
+    }
+    for (int y = 0; y < 16; ++y) {
+        std::copy(thumb.ptr<uint8_t>(y), thumb.ptr<uint8_t>(y) + 16, key.thumb.begin() + y * 16);
+    }
+    key.valid = true;
+    return key;
+}
+
+bool EmbeddingCache::matches(const FaceFingerprint& a, const FaceFingerprint& b) const {
+    if (__builtin_popcountll(a.hash ^ b.hash) > options_.maxHamming) return false;
+    int sum = 0;
+    for (size_t i = 0; i < a.thumb.size(); ++i) {
+        sum += std::abs(static_cast<int>(a.thumb[i]) - static_cast<int>(b.thumb[i]));
+    }
+    return sum <= options_.maxPixelDiff * static_cast<float>(a.thumb.size());
+}
+
+bool EmbeddingCache::lookup(const FaceFingerprint& key, std::vector<float>& embedding) {
+    if (!enabled() || !key.valid) return false;
+    const Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Scan linear: capacity kecil (ratusan-ribuan), popcount dulu sebelum thumbnail
+    for (auto it = lru_.begin(); it != lru_.end();) {
+        if (it->expires <= now) {
+            it = lru_.erase(it);
+            stats_.expired++;
+            continue;
+        }
+        if (matches(key, it->key)) {
+            lru_.splice(lru_.begin(), lru_, it);
+            embedding = lru_.front().embedding;
+            stats_.hits++;
+            return true;
+        }
+        ++it;
+    }
+    stats_.misses++;
+    return false;
+}
+
+void EmbeddingCache::insert(const FaceFingerprint& key, const std::vector<float>& embedding) {
+    if (!enabled() || !key.valid || embedding.empty()) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    lru_.push_front(Entry{key, embedding, Clock::now() + std::chrono::seconds(options_.ttlSec)});
+    while (lru_.size() > options_.capacity) {
+        lru_.pop_back();
+        stats_.evictions++;
+    }
+}
+
+void EmbeddingCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lru_.clear();
+}
+
+EmbeddingCache::Stats EmbeddingCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats s = stats_;
+    s.size = lru_.size();
+    s.capacity = options_.capacity;
+    return s;
+}
@@ -0,0 +1,76 @@
+#ifndef EMBEDDING_CACHE_HPP
+#define EMBEDDING_CACHE_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <vector>
+
+#include "embedder/face_embedder.hpp"
+
+class Config;
+
+struct EmbeddingCacheOptions {
+    size_t capacity = 0;          // jumlah entri maksimum, 0 = cache nonaktif
+    int ttlSec = 10;
+    int maxHamming = 3;           // jarak dHash 64-bit maksimum
+    float maxPixelDiff = 4.0f;    // rata-rata |selisih| thumbnail 16x16 (0..255)
+    bool aligned = true;          // sama dengan face_alignment embedder
+
+    static EmbeddingCacheOptions fromConfig(const Config& cfg, bool aligned);
+};
+
+// Sidik wajah murah: thumbnail gray 16x16 dari crop ter-align (atau crop box
+// tanpa landmark) dan dHash 64-bit dari thumbnail itu
+struct FaceFingerprint {
+    uint64_t hash = 0;
+    std::array<uint8_t, 256> thumb{};
+    bool valid = false;
+};
+
+// LRU embedding per sidik wajah, untuk retry /verify dengan frame nyaris sama.
+// Hit = dHash dalam maxHamming DAN thumbnail dalam maxPixelDiff (dHash saja
+// terlalu kasar untuk membedakan orang), belum lewat TTL. Memori terbatas:
+// capacity x (embedding + 256 byte). Thread-safe.
+class EmbeddingCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t expired = 0;
+        uint64_t evictions = 0;
+        size_t size = 0;
+        size_t capacity = 0;
+    };
+
+    explicit EmbeddingCache(const EmbeddingCacheOptions& options = EmbeddingCacheOptions());
+
+    void configure(const EmbeddingCacheOptions& options);
+    bool enabled() const { return options_.capacity > 0; }
+
+    FaceFingerprint fingerprint(const FaceInput& face) const;
+    // true dan embedding terisi bila ada entri yang cocok (entri naik ke depan LRU)
+    bool lookup(const FaceFingerprint& key, std::vector<float>& embedding);
+    void insert(const FaceFingerprint& key, const std::vector<float>& embedding);
+    void clear();
+    Stats stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    struct Entry {
+        FaceFingerprint key;
+        std::vector<float> embedding;
+        Clock::time_point expires;
+    };
+
+    EmbeddingCacheOptions options_;
+    mutable std::mutex mutex_;
+    std::list<Entry> lru_;   // depan = paling baru dipakai
+    Stats stats_;
+
+    bool matches(const FaceFingerprint& a, const FaceFingerprint& b) const;
+};
+
+#endif
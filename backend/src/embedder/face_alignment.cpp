@@ -0,0 +1,100 @@
+#include "face_alignment.hpp"
+#include <cmath>
+
+const std::array<cv::Point2f, 5>& arcfaceTemplate() {
+    static const std::array<cv::Point2f, 5> points = {{
+        {38.2946f, 51.6963f},
+        {73.5318f, 51.5014f},
+        {56.0252f, 71.7366f},
+        {41.5493f, 92.3655f},
+        {70.7299f, 92.2041f},
+    }};
+    return points;
+}
+
+cv::Mat similarityTransform(const std::vector<cv::Point2f>& landmarks, cv::Size size) {
+    if (landmarks.size() != 5) return cv::Mat();
+
+    const double sx = size.width / 112.0, sy = size.height / 112.0;
+    const auto& tmpl = arcfaceTemplate();
+    double srcMx = 0, srcMy = 0, dstMx = 0, dstMy = 0;
+    for (size_t i = 0; i < 5; ++i) {
+        srcMx += landmarks[i].x;
+        srcMy += landmarks[i].y;
+        dstMx += tmpl[i].x * sx;
+        dstMy += tmpl[i].y * sy;
+    }
+    srcMx /= 5; srcMy /= 5; dstMx /= 5; dstMy /= 5;
+
+    // Solusi tertutup untuk [a -b; b a]: a = sum(p.q) / sum|p|^2, b = sum(p x q) / sum|p|^2
+    double a = 0, b = 0, var = 0;
+    for (size_t i = 0; i < 5; ++i) {
+        double px = landmarks[i].x - srcMx, py = landmarks[i].y - srcMy;
+        double qx = tmpl[i].x * sx - dstMx, qy = tmpl[i].y * sy - dstMy;
+        a += px * qx + py * qy;
+        b += px * qy - py * qx;
+        var += px * px + py * py;
+    }
+    if (var < 1e-6) return cv::Mat();
+    a /= var;
+    b /= var;
+
+    cv::Mat m(2, 3, CV_64F);
+    m.at<double>(0, 0) = a;
+    m.at<double>(0, 1) = -b;
+    m.at<double>(0, 2) = dstMx - (a * srcMx - b * srcMy);
+    m.at<double>(1, 0) = b;
+    m.at<double>(1, 1) = a;
+    m.at<double>(1, 2) = dstMy - (b * srcMx + a * srcMy);
+    return m;
+}
+
+void warpNormalizeInto(const cv::Mat& image, const cv::Mat& transform, cv::Size size,
+                       const NormalizeParams& norm, float* chw) {
+    // Inverse transform: piksel output (u, v) -> koordinat sumber
+    const double* t = transform.ptr<double>();
+    const double det = t[0] * t[4] - t[1] * t[3];
+    const double i00 = t[4] / det, i01 = -t[1] / det, i10 = -t[3] / det, i11 = t[0] / det;
+    const double i02 = -(i00 * t[2] + i01 * t[5]), i12 = -(i10 * t[2] + i11 * t[5]);
+
+    const int cols = image.cols, rows = image.rows;
+    const size_t plane = static_cast<size_t>(size.width) * size.height;
+    // Channel input (B, G, R) -> plane output
+    const int planeOf[3] = {norm.swapRB ? 2 : 0, 1, norm.swapRB ? 0 : 2};
+
+    for (int v = 0; v < size.height; ++v) {
+        for (int u = 0; u < size.width; ++u) {
+            const float x = static_cast<float>(i00 * u + i01 * v + i02);
+            const float y = static_cast<float>(i10 * u + i11 * v + i12);
+            const size_t o = static_cast<size_t>(v) * size.width + u;
+            const int x0 = static_cast<int>(std::floor(x)), y0 = static_cast<int>(std::floor(y));
+            if (x0 < -1 || y0 < -1 || x0 >= cols || y0 >= rows) {
+                for (int c = 0; c < 3; ++c) chw[planeOf[c] * plane + o] = norm.bias[planeOf[c]];
+                continue;
+            }
+            const float fx = x - x0, fy = y - y0;
+            const float w[4] = {(1 - fx) * (1 - fy), fx * (1 - fy), (1 - fx) * fy, fx * fy};
+            float acc[3] = {0.0f, 0.0f, 0.0f};
+            // 4 tetangga; di luar gambar bernilai 0 (border constant)
+            for (int k = 0; k < 4; ++k) {
+                const int xx = x0 + (k & 1), yy = y0 + (k >> 1);
+                if (xx < 0 || yy < 0 || xx >= cols || yy >= rows) continue;
+                const uchar* p = image.ptr<uchar>(yy) + 3 * xx;
+                acc[0] += w[k] * p[0];
+                acc[1] += w[k] * p[1];
+                acc[2] += w[k] * p[2];
+            }
+            for (int c = 0; c < 3; ++c) {
+                chw[planeOf[c] * plane + o] = acc[c] * norm.scale[planeOf[c]] + norm.bias[planeOf[c]];
+            }
+        }
+    }
+}
+
+cv::Mat alignFace(const cv::Mat& image, const std::vector<cv::Point2f>& landmarks, cv::Size size) {
+    cv::Mat m = similarityTransform(landmarks, size);
+    if (m.empty() || image.empty()) return cv::Mat();
+    cv::Mat aligned;
+    cv::warpAffine(image, aligned, m, size, cv::INTER_LINEAR, cv::BORDER_CONSTANT, cv::Scalar());
+    return aligned;
+}
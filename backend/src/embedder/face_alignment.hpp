@@ -0,0 +1,28 @@
+#ifndef FACE_ALIGNMENT_HPP
+#define FACE_ALIGNMENT_HPP
+
+#include <opencv2/opencv.hpp>
+#include <array>
+#include <vector>
+
+#include "inference/preprocess.hpp"
+
+// Posisi 5 landmark ArcFace (insightface) pada input 112x112: mata kiri,
+// mata kanan, hidung, mulut kiri, mulut kanan (urutan sama dengan FaceDetection)
+const std::array<cv::Point2f, 5>& arcfaceTemplate();
+
+// Similarity transform (rotasi + skala seragam + translasi, least squares /
+// Umeyama) dari landmark ke template yang diskalakan ke size.
+// Return 2x3 CV_64F, kosong bila jumlah landmark bukan 5 atau degenerate.
+cv::Mat similarityTransform(const std::vector<cv::Point2f>& landmarks, cv::Size size);
+
+// Warp bilinear (setara cv::warpAffine INTER_LINEAR, border 0) sekaligus
+// normalisasi dan HWC -> CHW (lihat ImagePreprocessor), langsung ke tensor
+// size.height x size.width. Tanpa Mat perantara. image harus CV_8UC3.
+void warpNormalizeInto(const cv::Mat& image, const cv::Mat& transform, cv::Size size,
+                       const NormalizeParams& norm, float* chw);
+
+// Crop ter-align BGR untuk debug / tool
+cv::Mat alignFace(const cv::Mat& image, const std::vector<cv::Point2f>& landmarks, cv::Size size);
+
+#endif
@@ -1,53 +1,120 @@
 #include "face_embedder.hpp"
+#include "face_alignment.hpp"
 #include <iostream>
 #include <cmath>
+#include <cstring>
+
+static std::vector<FaceInput> toInputs(const std::vector<cv::Mat>& faceImages) {
+    std::vector<FaceInput> faces(faceImages.size());
+    for (size_t i = 0; i < faceImages.size(); ++i) faces[i].image = faceImages[i];
+    return faces;
+}
 
 FaceEmbedder::FaceEmbedder() 
     : isLoaded(false), 
       inputSize(112, 112), 
       mean(127.5, 127.5, 127.5), 
-      std(127.5, 127.5, 127.5) {}
+      std(127.5, 127.5, 127.5) {
+    initPreprocessor();
+}
 
 FaceEmbedder::FaceEmbedder(const std::string& modelPath) 
     : isLoaded(false), 
       inputSize(112, 112), 
       mean(127.5, 127.5, 127.5), 
       std(127.5, 127.5, 127.5) {
+    initPreprocessor();
     loadModel(modelPath);
 }
 
-bool FaceEmbedder::loadModel(const std::string& modelPath) {
+void FaceEmbedder::initPreprocessor() {
+    // Sama dengan pipeline lama (resize, blobFromImage dengan mean + swapRB,
+    // lalu /127.5 dan -1): v * (1/127.5) + (-mean/127.5 - 1)
+    preprocessor.configure(inputSize,
+                           NormalizeParams::affine(1.0f / 127.5f, -static_cast<float>(mean[0]) / 127.5f - 1.0f),
+                           cv::INTER_LINEAR);
+}
+
+bool FaceEmbedder::loadModel(const std::string& modelPath, const InferenceOptions& opts) {
+    options = opts;
+    isLoaded = false;
     try {
-        net = cv::dnn::readNetFromONNX(modelPath);
-        
-        // Gunakan CPU (bisa ganti ke CUDA jika ada)
-        net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
-        net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
-        
+        if (options.useOrt()) {
+            session = createOrtSession(modelPath, options);
+            Ort::AllocatorWithDefaultOptions allocator;
+            inputName = session.GetInputNameAllocated(0, allocator).get();
+            outputName = session.GetOutputNameAllocated(0, allocator).get();
+            // inputShape: [N, 3, 112, 112], N = -1 bila batch dinamis
+            auto inputShape = session.GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+            batchSupported = !inputShape.empty() && inputShape[0] < 0;
+            if (!batchSupported) {
+                std::cout << "[Embedder] " << modelPath << " has a static batch of 1, faces run one per "
+                          << "inference (tools/export_dynamic_batch.py makes the batch dynamic)" << std::endl;
+            }
+        } else {
+            net = cv::dnn::readNetFromONNX(modelPath);
+
+            // Gunakan CPU (bisa ganti ke CUDA jika ada)
+            net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+            net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+            batchSupported = true;
+        }
+
         isLoaded = true;
-        std::cout << "Model loaded: " << modelPath << std::endl;
-    } catch (const cv::Exception& e) {
+        std::cout << "Model loaded: " << modelPath << " (" << options.describe() << ")" << std::endl;
+    } catch (const std::exception& e) {
         std::cerr << "Error loading model: " << e.what() << std::endl;
-        isLoaded = false;
     }
     return isLoaded;
 }
 
-cv::Mat FaceEmbedder::preprocess(const cv::Mat& faceImage) {
-    cv::Mat resized, blob;
-    cv::resize(faceImage, resized, inputSize);
-    
-    // Konversi ke blob dengan normalisasi (mean=127.5, std=127.5) [citation:2]
-    blob = cv::dnn::blobFromImage(resized, 1.0, inputSize, mean, true, false);
-    
-    // Manual per-channel normalization jika diperlukan
-    // Karena blobFromImage hanya melakukan scale=1.0, kita perlu normalisasi manual
-    blob /= 127.5;  // scale ke [0,2]
-    blob -= 1.0;    // shift ke [-1,1]
-    
+cv::Mat FaceEmbedder::forward(float* input, int batch) {
+    const int dims[4] = {batch, 3, inputSize.height, inputSize.width};
+    if (!options.useOrt()) {
+        // Header di atas inputBuffer, tanpa copy
+        net.setInput(cv::Mat(4, dims, CV_32F, input));
+        return net.forward().reshape(1, batch);
+    }
+
+    std::vector<int64_t> inputShape = {dims[0], dims[1], dims[2], dims[3]};
+    Ort::MemoryInfo memInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+    Ort::Value inputTensor = Ort::Value::CreateTensor<float>(
+        memInfo, input, static_cast<size_t>(batch) * preprocessor.tensorSize(), inputShape.data(), inputShape.size());
+
+    const char* inputNames[] = {inputName.c_str()};
+    const char* outputNames[] = {outputName.c_str()};
+    auto outputTensors = session.Run(Ort::RunOptions{nullptr}, inputNames, &inputTensor, 1, outputNames, 1);
+
+    const float* data = outputTensors[0].GetTensorData<float>();
+    size_t count = outputTensors[0].GetTensorTypeAndShapeInfo().GetElementCount();
+    return cv::Mat(batch, static_cast<int>(count / batch), CV_32F, const_cast<float*>(data)).clone();
+}
+
+float* FaceEmbedder::preprocessBatch(const FaceInput* faces, size_t count) {
+    const size_t perFace = preprocessor.tensorSize();
+    float* blob = inputBuffer.reserve(count * perFace);
+    for (size_t i = 0; i < count; ++i) {
+        const FaceInput& face = faces[i];
+        float* dst = blob + i * perFace;
+        cv::Mat transform;
+        if (align && face.image.type() == CV_8UC3) {
+            transform = similarityTransform(face.landmarks, inputSize);
+        }
+        if (!transform.empty()) {
+            // Warp ke template ArcFace + normalisasi dalam satu pass, langsung ke blob
+            warpNormalizeInto(face.image, transform, inputSize, preprocessor.normalize(), dst);
+        } else {
+            preprocessor.run(face.box.empty() ? face.image : face.image(face.box), dst);
+        }
+    }
     return blob;
 }
 
+cv::Mat FaceEmbedder::inputBlob(const FaceInput& face) {
+    const int dims[4] = {1, 3, inputSize.height, inputSize.width};
+    return cv::Mat(4, dims, CV_32F, preprocessBatch(&face, 1)).clone();
+}
+
 void FaceEmbedder::l2Normalize(std::vector<float>& embedding) {
     float norm = 0.0f;
     for (float val : embedding) {
@@ -69,13 +136,13 @@ std::vector<float> FaceEmbedder::getEmbedding(const cv::Mat& faceImage) {
     }
     
     try {
-        cv::Mat blob = preprocess(faceImage);
-        net.setInput(blob);
-        cv::Mat output = net.forward();
+        FaceInput face;
+        face.image = faceImage;
+        cv::Mat output = forward(preprocessBatch(&face, 1), 1);
         
         // Convert ke vector float (dimensi 512) [citation:2]
         embedding.assign((float*)output.data, (float*)output.data + output.total());
-    } catch (const cv::Exception& e) {
+    } catch (const std::exception& e) {
         std::cerr << "Embedding error: " << e.what() << std::endl;
     }
     
@@ -88,4 +155,69 @@ std::vector<float> FaceEmbedder::getNormalizedEmbedding(const cv::Mat& faceImage
         l2Normalize(embedding);
     }
     return embedding;
-}
\ No newline at end of file
+}
+
+std::vector<float> FaceEmbedder::getNormalizedEmbedding(const FaceInput& face) {
+    std::vector<std::vector<float>> embeddings = getNormalizedEmbeddings(std::vector<FaceInput>{face});
+    return embeddings[0];
+}
+
+std::vector<std::vector<float>> FaceEmbedder::getEmbeddings(const std::vector<cv::Mat>& faceImages) {
+    return getEmbeddings(toInputs(faceImages));
+}
+
+std::vector<std::vector<float>> FaceEmbedder::getEmbeddings(const std::vector<FaceInput>& faces) {
+    std::vector<std::vector<float>> embeddings(faces.size());
+    if (!isLoaded || faces.empty()) {
+        return embeddings;
+    }
+
+    std::vector<FaceInput> valid;
+    std::vector<size_t> slots;
+    for (size_t i = 0; i < faces.size(); ++i) {
+        if (faces[i].image.empty()) continue;
+        valid.push_back(faces[i]);
+        slots.push_back(i);
+    }
+
+    if (valid.size() > 1 && batchSupported) {
+        try {
+            cv::Mat output = forward(preprocessBatch(valid.data(), valid.size()), static_cast<int>(valid.size()));
+            size_t dim = output.total() / valid.size();
+            if (output.total() == valid.size() * dim && dim == static_cast<size_t>(getEmbeddingSize())) {
+                const float* data = output.ptr<float>();
+                for (size_t b = 0; b < valid.size(); ++b) {
+                    embeddings[slots[b]].assign(data + b * dim, data + (b + 1) * dim);
+                }
+                return embeddings;
+            }
+            std::cerr << "Embedding batch output " << output.total() << " values for "
+                      << valid.size() << " faces, using batch size 1" << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "Embedding batch error, using batch size 1: " << e.what() << std::endl;
+        }
+        batchSupported = false;
+    }
+
+    for (size_t b = 0; b < valid.size(); ++b) {
+        try {
+            cv::Mat output = forward(preprocessBatch(&valid[b], 1), 1);
+            embeddings[slots[b]].assign(output.ptr<float>(), output.ptr<float>() + output.total());
+        } catch (const std::exception& e) {
+            std::cerr << "Embedding error: " << e.what() << std::endl;
+        }
+    }
+    return embeddings;
+}
+
+std::vector<std::vector<float>> FaceEmbedder::getNormalizedEmbeddings(const std::vector<cv::Mat>& faceImages) {
+    return getNormalizedEmbeddings(toInputs(faceImages));
+}
+
+std::vector<std::vector<float>> FaceEmbedder::getNormalizedEmbeddings(const std::vector<FaceInput>& faces) {
+    std::vector<std::vector<float>> embeddings = getEmbeddings(faces);
+    for (auto& embedding : embeddings) {
+        if (!embedding.empty()) l2Normalize(embedding);
+    }
+    return embeddings;
+}
@@ -6,6 +6,19 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <onnxruntime_cxx_api.h>
+
+#include "inference/ort_session.hpp"
+#include "inference/preprocess.hpp"
+
+// Wajah untuk embedder. box kosong = seluruh image adalah crop wajah.
+// Dengan 5 landmark (dan alignment aktif) wajah di-warp ke template ArcFace;
+// tanpa landmark image(box) di-resize ke 112x112 seperti sebelumnya.
+struct FaceInput {
+    cv::Mat image;
+    cv::Rect box;
+    std::vector<cv::Point2f> landmarks;
+};
 
 class FaceEmbedder {
 public:
@@ -13,20 +26,48 @@ public:
     explicit FaceEmbedder(const std::string& modelPath);
     ~FaceEmbedder() = default;
 
-    bool loadModel(const std::string& modelPath);
+    // backend "ort" (default) atau "opencv" (cv::dnn), lihat InferenceOptions
+    bool loadModel(const std::string& modelPath, const InferenceOptions& options = InferenceOptions());
     std::vector<float> getEmbedding(const cv::Mat& faceImage);
     std::vector<float> getNormalizedEmbedding(const cv::Mat& faceImage);
-    
+    std::vector<float> getNormalizedEmbedding(const FaceInput& face);
+
+    // Satu forward pass untuk beberapa wajah (batch NCHW). Bila model menolak
+    // batch > 1, otomatis kembali ke forward per gambar. Gambar kosong -> vector kosong.
+    std::vector<std::vector<float>> getEmbeddings(const std::vector<cv::Mat>& faceImages);
+    std::vector<std::vector<float>> getNormalizedEmbeddings(const std::vector<cv::Mat>& faceImages);
+    std::vector<std::vector<float>> getEmbeddings(const std::vector<FaceInput>& faces);
+    std::vector<std::vector<float>> getNormalizedEmbeddings(const std::vector<FaceInput>& faces);
+    // false untuk model ONNX batch 1 (mis. arcfaceresnet100-8): batch dijalankan per wajah
+    bool supportsBatch() const { return batchSupported; }
+
+    // false: landmark diabaikan, selalu resize crop (embedding lama di DB tetap cocok)
+    void setAlignment(bool enabled) { align = enabled; }
+    bool alignment() const { return align; }
+
     int getEmbeddingSize() const { return 512; }
+    // Blob NCHW hasil preprocess (salinan), untuk tool kalibrasi / benchmark
+    cv::Mat inputBlob(const FaceInput& face);
 
 private:
     cv::dnn::Net net;
+    Ort::Session session{nullptr};
+    std::string inputName, outputName;
+    InferenceOptions options;
     bool isLoaded;
     cv::Size inputSize;
     cv::Scalar mean;
     cv::Scalar std;
+    bool batchSupported = true;
+    bool align = false;  // default sama dengan face_alignment = 0
+    ImagePreprocessor preprocessor;
+    TensorBuffer inputBuffer;   // input NCHW, dipakai ulang antar batch
     
-    cv::Mat preprocess(const cv::Mat& faceImage);
+    void initPreprocessor();
+    // Menulis count wajah ke inputBuffer, return pointer ke awal tensor
+    float* preprocessBatch(const FaceInput* faces, size_t count);
+    // Tensor NCHW [batch x 3 x 112 x 112] -> Mat [N x dim], lewat backend yang aktif
+    cv::Mat forward(float* input, int batch);
     void l2Normalize(std::vector<float>& embedding);
 };
 
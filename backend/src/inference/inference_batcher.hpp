@@ -0,0 +1,164 @@
+#ifndef INFERENCE_BATCHER_HPP
+#define INFERENCE_BATCHER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Micro-batching: request paralel dikumpulkan menjadi satu batch (maks
+// maxBatch item, atau sampai item tertua menunggu maxWait), dijalankan dengan
+// satu forward pass, lalu hasilnya dikembalikan ke masing-masing pemanggil.
+//
+// Tiap worker menjalankan satu batch pada satu waktu; RunFn biasanya
+// meminjam instance model dari ModelPool, jadi jumlah worker = ukuran pool.
+// Batch yang gagal (exception) diteruskan ke semua pemanggil di batch itu.
+// Job dengan CancelToken yang sudah di-set dibuang sebelum masuk batch
+// (future-nya gagal dengan "cancelled"); job yang sudah berjalan tetap selesai.
+template <typename In, typename Out>
+class InferenceBatcher {
+public:
+    using RunFn = std::function<std::vector<Out>(const std::vector<In>&)>;
+    using Clock = std::chrono::steady_clock;
+    using CancelToken = std::shared_ptr<std::atomic<bool>>;
+
+    struct Stats {
+        uint64_t batches = 0;
+        uint64_t items = 0;
+        size_t largestBatch = 0;
+        uint64_t cancelled = 0;
+    };
+
+    InferenceBatcher() = default;
+    ~InferenceBatcher() { stop(); }
+    InferenceBatcher(const InferenceBatcher&) = delete;
+    InferenceBatcher& operator=(const InferenceBatcher&) = delete;
+
+    void start(RunFn run, size_t workers, size_t maxBatch, std::chrono::microseconds maxWait) {
+        stop();
+        run_ = std::move(run);
+        maxBatch_ = std::max<size_t>(maxBatch, 1);
+        maxWait_ = maxWait;
+        stopping_ = false;
+        for (size_t i = 0; i < std::max<size_t>(workers, 1); ++i) {
+            workers_.emplace_back(&InferenceBatcher::workerLoop, this);
+        }
+    }
+
+    // Job yang masih antre tetap dijalankan sebelum worker berhenti
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        for (auto& t : workers_) t.join();
+        workers_.clear();
+    }
+
+    bool running() const { return !workers_.empty(); }
+    size_t maxBatch() const { return maxBatch_; }
+
+    std::future<Out> submit(In input, CancelToken cancel = nullptr) {
+        Job job{std::move(input), std::promise<Out>(), Clock::now(), std::move(cancel)};
+        std::future<Out> result = job.promise.get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (workers_.empty() || stopping_) {
+                throw std::runtime_error("InferenceBatcher: not running");
+            }
+            queue_.push_back(std::move(job));
+        }
+        cv_.notify_one();
+        return result;
+    }
+
+    // Blocking: submit lalu tunggu hasil
+    Out run(In input) { return submit(std::move(input)).get(); }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+private:
+    struct Job {
+        In input;
+        std::promise<Out> promise;
+        Clock::time_point enqueued;
+        CancelToken cancel;
+    };
+
+    RunFn run_;
+    size_t maxBatch_ = 1;
+    std::chrono::microseconds maxWait_{0};
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Job> queue_;
+    std::vector<std::thread> workers_;
+    bool stopping_ = false;
+    Stats stats_;
+
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) return;  // stopping
+
+            // Tunggu batch penuh atau deadline item tertua
+            const Clock::time_point deadline = queue_.front().enqueued + maxWait_;
+            while (!stopping_ && !queue_.empty() && queue_.size() < maxBatch_ && Clock::now() < deadline) {
+                cv_.wait_until(lock, deadline);
+            }
+            if (queue_.empty()) continue;  // sudah diambil worker lain
+
+            std::vector<Job> jobs;
+            jobs.reserve(std::min(maxBatch_, queue_.size()));
+            while (jobs.size() < maxBatch_ && !queue_.empty()) {
+                Job job = std::move(queue_.front());
+                queue_.pop_front();
+                if (job.cancel && job.cancel->load(std::memory_order_acquire)) {
+                    job.promise.set_exception(std::make_exception_ptr(std::runtime_error("InferenceBatcher: cancelled")));
+                    stats_.cancelled++;
+                    continue;
+                }
+                jobs.push_back(std::move(job));
+            }
+            if (jobs.empty()) continue;
+            const size_t n = jobs.size();
+            stats_.batches++;
+            stats_.items += n;
+            stats_.largestBatch = std::max(stats_.largestBatch, n);
+            lock.unlock();
+            // Sisa antrean untuk worker lain
+            if (n == maxBatch_) cv_.notify_one();
+
+            std::vector<In> inputs;
+            inputs.reserve(n);
+            for (auto& job : jobs) inputs.push_back(std::move(job.input));
+            try {
+                std::vector<Out> outputs = run_(inputs);
+                if (outputs.size() != n) {
+                    throw std::runtime_error("InferenceBatcher: batch returned " + std::to_string(outputs.size()) +
+                                             " results for " + std::to_string(n) + " inputs");
+                }
+                for (size_t i = 0; i < n; ++i) jobs[i].promise.set_value(std::move(outputs[i]));
+            } catch (...) {
+                for (auto& job : jobs) job.promise.set_exception(std::current_exception());
+            }
+
+            lock.lock();
+        }
+    }
+};
+
+#endif
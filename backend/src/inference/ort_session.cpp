@@ -0,0 +1,109 @@
+#include "ort_session.hpp"
+#include "config/load_config.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include <sys/stat.h>
+
+static GraphOptimizationLevel parseOptLevel(const std::string& level) {
+    if (level == "disable") return ORT_DISABLE_ALL;
+    if (level == "basic") return ORT_ENABLE_BASIC;
+    if (level == "extended") return ORT_ENABLE_EXTENDED;
+    if (level != "all") {
+        printf("[Inference] Unknown graph optimization '%s', using 'all'\n", level.c_str());
+    }
+    return ORT_ENABLE_ALL;
+}
+
+InferenceOptions InferenceOptions::fromConfig(const Config& cfg, const std::string& prefix, int defaultThreads) {
+    InferenceOptions o;
+    o.backend = cfg.getString(prefix + "_backend", o.backend);
+    int intra = cfg.getInt(prefix + "_intra_threads", 0);
+    o.intraOpThreads = intra > 0 ? intra : std::max(1, defaultThreads);
+    o.interOpThreads = std::max(1, cfg.getInt(prefix + "_inter_threads", o.interOpThreads));
+    o.graphOptimization = cfg.getString(prefix + "_graph_opt", o.graphOptimization);
+    o.memPattern = cfg.getInt(prefix + "_mem_pattern", 1) != 0;
+    o.cpuArena = cfg.getInt(prefix + "_cpu_arena", 1) != 0;
+    o.allowSpinning = cfg.getInt("ort_allow_spinning", 0) != 0;
+    o.optimizedModelDir = cfg.getString("ort_optimized_cache_dir", "");
+    return o;
+}
+
+std::string InferenceOptions::describe() const {
+    std::ostringstream ss;
+    if (!useOrt()) {
+        ss << "opencv dnn";
+        return ss.str();
+    }
+    ss << "ort intra=" << intraOpThreads << " inter=" << interOpThreads << " opt=" << graphOptimization
+       << " mem_pattern=" << memPattern << " arena=" << cpuArena;
+    if (!optimizedModelDir.empty()) ss << " cache=" << optimizedModelDir;
+    return ss.str();
+}
+
+Ort::Env& ortEnv() {
+    static Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "FaceRecognition");
+    return env;
+}
+
+// Graph hasil optimasi bergantung pada versi ORT dan instruksi CPU (layout
+// NCHWc, kernel AVX2/AVX-512): keduanya masuk nama file cache supaya image /
+// host lain tidak memuat cache yang tidak cocok dari volume yang sama.
+static std::string cacheFingerprint() {
+    std::string flags;
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.compare(0, 5, "flags") == 0 || line.compare(0, 8, "Features") == 0) {
+            flags = line.substr(line.find(':') + 1);
+            break;
+        }
+    }
+    uint32_t hash = 2166136261u;  // FNV-1a
+    for (unsigned char c : flags) {
+        hash = (hash ^ c) * 16777619u;
+    }
+    char cpu[16];
+    snprintf(cpu, sizeof(cpu), "%08x", hash);
+    return std::string("ort") + OrtGetApiBase()->GetVersionString() + ".cpu" + cpu;
+}
+
+static bool newerOrSame(const std::string& path, const std::string& than) {
+    struct stat a, b;
+    if (::stat(path.c_str(), &a) != 0 || ::stat(than.c_str(), &b) != 0) return false;
+    return a.st_mtime >= b.st_mtime;
+}
+
+Ort::Session createOrtSession(const std::string& modelPath, const InferenceOptions& options) {
+    Ort::SessionOptions opts;
+    opts.SetIntraOpNumThreads(options.intraOpThreads);
+    opts.SetInterOpNumThreads(options.interOpThreads);
+    opts.SetExecutionMode(options.interOpThreads > 1 ? ORT_PARALLEL : ORT_SEQUENTIAL);
+    if (options.memPattern) opts.EnableMemPattern(); else opts.DisableMemPattern();
+    if (options.cpuArena) opts.EnableCpuMemArena(); else opts.DisableCpuMemArena();
+    opts.AddConfigEntry("session.intra_op.allow_spinning", options.allowSpinning ? "1" : "0");
+
+    GraphOptimizationLevel level = parseOptLevel(options.graphOptimization);
+    std::string loadPath = modelPath;
+    if (!options.optimizedModelDir.empty() && level != ORT_DISABLE_ALL) {
+        std::string name = modelPath.substr(modelPath.find_last_of('/') + 1);
+        name = name.substr(0, name.rfind(".onnx"));
+        std::string cached = options.optimizedModelDir + "/" + name + "." + options.graphOptimization + "." +
+                             cacheFingerprint() + ".opt.onnx";
+        if (newerOrSame(cached, modelPath)) {
+            // Graph sudah dioptimasi, cukup load
+            loadPath = cached;
+            level = ORT_DISABLE_ALL;
+            printf("[Inference] Using optimized model cache %s\n", cached.c_str());
+        } else {
+            ::mkdir(options.optimizedModelDir.c_str(), 0755);
+            opts.SetOptimizedModelFilePath(cached.c_str());
+        }
+    }
+    opts.SetGraphOptimizationLevel(level);
+
+    return Ort::Session(ortEnv(), loadPath.c_str(), opts);
+}
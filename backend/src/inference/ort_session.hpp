@@ -0,0 +1,37 @@
+#ifndef ORT_SESSION_HPP
+#define ORT_SESSION_HPP
+
+#include <onnxruntime_cxx_api.h>
+#include <string>
+
+class Config;
+
+// Pengaturan inferensi per model, dibaca dari config.txt dengan prefix
+// (mis. embedder_backend, embedder_intra_threads, depth_graph_opt, ...)
+struct InferenceOptions {
+    std::string backend = "ort";            // "ort" | "opencv" (cv::dnn, untuk A/B)
+    int intraOpThreads = 1;
+    int interOpThreads = 1;
+    std::string graphOptimization = "all";  // disable | basic | extended | all
+    bool memPattern = true;
+    bool cpuArena = true;
+    bool allowSpinning = false;             // spin thread ORT antar Run; boros CPU bila banyak session
+    std::string optimizedModelDir;          // kosong: model teroptimasi tidak di-cache
+
+    bool useOrt() const { return backend != "opencv"; }
+
+    // defaultThreads dipakai bila <prefix>_intra_threads = 0 / tidak ada
+    static InferenceOptions fromConfig(const Config& cfg, const std::string& prefix, int defaultThreads);
+    std::string describe() const;
+};
+
+// Satu Ort::Env untuk seluruh proses (thread pool & logger bersama)
+Ort::Env& ortEnv();
+
+// Membuat session sesuai options. Bila optimizedModelDir di-set, graph hasil
+// optimasi disimpan saat start pertama lalu dimuat langsung (tanpa optimasi
+// ulang) pada start berikutnya. Nama file cache memuat versi ORT dan sidik
+// flag CPU, jadi cache dari versi / host lain tidak pernah dipakai.
+Ort::Session createOrtSession(const std::string& modelPath, const InferenceOptions& options);
+
+#endif
@@ -0,0 +1,242 @@
+#include "preprocess.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PREPROCESS_X86 1
+#endif
+
+namespace {
+
+// Satu baris output resize linear. Channel mengikuti urutan input (B, G, R).
+struct LinearRow {
+    const uchar* r0;
+    const uchar* r1;
+    float wy;
+    int srcLen;          // cols * 3
+    const int* xofs0;
+    const int* xofs1;
+    const float* xw;
+    int width;
+    float* out[3];
+    float scale[3];
+    float bias[3];
+};
+
+void linearRowScalar(const LinearRow& row, float*) {
+    for (int x = 0; x < row.width; ++x) {
+        const int a = row.xofs0[x], b = row.xofs1[x];
+        const float wx = row.xw[x];
+        for (int c = 0; c < 3; ++c) {
+            float top = row.r0[a + c] + wx * (row.r0[b + c] - row.r0[a + c]);
+            float bot = row.r1[a + c] + wx * (row.r1[b + c] - row.r1[a + c]);
+            row.out[c][x] = (top + row.wy * (bot - top)) * row.scale[c] + row.bias[c];
+        }
+    }
+}
+
+#ifdef PREPROCESS_X86
+// Blend vertikal ke tmp (kontigu, 8 lane), lalu interpolasi horizontal 8 piksel
+// output sekaligus lewat gather. Urutan blend beda dengan skalar (vertikal dulu),
+// selisihnya hanya pembulatan float.
+__attribute__((target("avx2,fma")))
+void linearRowAvx2(const LinearRow& row, float* tmp) {
+    const __m256 wy = _mm256_set1_ps(row.wy);
+    int i = 0;
+    for (; i + 8 <= row.srcLen; i += 8) {
+        __m256 a = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(row.r0 + i))));
+        __m256 b = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(row.r1 + i))));
+        _mm256_storeu_ps(tmp + i, _mm256_fmadd_ps(wy, _mm256_sub_ps(b, a), a));
+    }
+    for (; i < row.srcLen; ++i) tmp[i] = row.r0[i] + row.wy * (row.r1[i] - row.r0[i]);
+
+    int x = 0;
+    for (; x + 8 <= row.width; x += 8) {
+        const __m256i ia = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row.xofs0 + x));
+        const __m256i ib = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row.xofs1 + x));
+        const __m256 wx = _mm256_loadu_ps(row.xw + x);
+        for (int c = 0; c < 3; ++c) {
+            const __m256i off = _mm256_set1_epi32(c);
+            __m256 va = _mm256_i32gather_ps(tmp, _mm256_add_epi32(ia, off), 4);
+            __m256 vb = _mm256_i32gather_ps(tmp, _mm256_add_epi32(ib, off), 4);
+            __m256 v = _mm256_fmadd_ps(wx, _mm256_sub_ps(vb, va), va);
+            _mm256_storeu_ps(row.out[c] + x,
+                             _mm256_fmadd_ps(v, _mm256_set1_ps(row.scale[c]), _mm256_set1_ps(row.bias[c])));
+        }
+    }
+    for (; x < row.width; ++x) {
+        const int a = row.xofs0[x], b = row.xofs1[x];
+        const float wx = row.xw[x];
+        for (int c = 0; c < 3; ++c) {
+            float v = tmp[a + c] + wx * (tmp[b + c] - tmp[a + c]);
+            row.out[c][x] = v * row.scale[c] + row.bias[c];
+        }
+    }
+}
+#endif
+
+using LinearRowFn = void (*)(const LinearRow&, float*);
+
+struct Dispatch {
+    LinearRowFn linearRow;
+    const char* name;
+};
+
+Dispatch resolve() {
+    Dispatch d{linearRowScalar, "scalar"};
+#ifdef PREPROCESS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) d = {linearRowAvx2, "avx2"};
+#endif
+    return d;
+}
+
+const Dispatch& dispatch() {
+    static const Dispatch d = resolve();
+    return d;
+}
+
+} // namespace
+
+NormalizeParams NormalizeParams::meanStd(const float mean[3], const float std[3], float range, bool swapRB) {
+    NormalizeParams p;
+    for (int c = 0; c < 3; ++c) {
+        p.scale[c] = 1.0f / (range * std[c]);
+        p.bias[c] = -mean[c] / std[c];
+    }
+    p.swapRB = swapRB;
+    return p;
+}
+
+NormalizeParams NormalizeParams::affine(float scale, float bias, bool swapRB) {
+    NormalizeParams p;
+    for (int c = 0; c < 3; ++c) {
+        p.scale[c] = scale;
+        p.bias[c] = bias;
+    }
+    p.swapRB = swapRB;
+    return p;
+}
+
+ImagePreprocessor::ImagePreprocessor(cv::Size size, const NormalizeParams& norm, int interpolation) {
+    configure(size, norm, interpolation);
+}
+
+const char* ImagePreprocessor::activeIsa() {
+    return dispatch().name;
+}
+
+void ImagePreprocessor::configure(cv::Size size, const NormalizeParams& norm, int interpolation) {
+    size_ = size;
+    norm_ = norm;
+    interpolation_ = interpolation;
+    tableCols_ = -1;
+}
+
+void ImagePreprocessor::run(const cv::Mat& bgr, float* chw) {
+    if (bgr.type() != CV_8UC3) {
+        if (bgr.type() == CV_8UC1) cv::cvtColor(bgr, converted_, cv::COLOR_GRAY2BGR);
+        else if (bgr.type() == CV_8UC4) cv::cvtColor(bgr, converted_, cv::COLOR_BGRA2BGR);
+        else throw std::invalid_argument("ImagePreprocessor: expected 8-bit image");
+        run(converted_, chw);
+        return;
+    }
+    if (bgr.size() == size_) {
+        normalizeRows(bgr, chw);
+    } else if (interpolation_ == cv::INTER_LINEAR) {
+        resizeLinear(bgr, chw);
+    } else {
+        // resized_ dialokasikan sekali (ukuran output tetap)
+        cv::resize(bgr, resized_, size_, 0, 0, interpolation_);
+        normalizeRows(resized_, chw);
+    }
+}
+
+void ImagePreprocessor::normalizeRows(const cv::Mat& bgr, float* chw) const {
+    const size_t plane = static_cast<size_t>(size_.area());
+    // Channel input (B, G, R) -> plane output
+    const int outB = norm_.swapRB ? 2 : 0, outR = norm_.swapRB ? 0 : 2;
+    float* __restrict pB = chw + outB * plane;
+    float* __restrict pG = chw + plane;
+    float* __restrict pR = chw + outR * plane;
+    const float sB = norm_.scale[outB], sG = norm_.scale[1], sR = norm_.scale[outR];
+    const float bB = norm_.bias[outB], bG = norm_.bias[1], bR = norm_.bias[outR];
+
+    for (int y = 0; y < size_.height; ++y) {
+        const uchar* __restrict row = bgr.ptr<uchar>(y);
+        const size_t o = static_cast<size_t>(y) * size_.width;
+        for (int x = 0; x < size_.width; ++x) {
+            pB[o + x] = row[3 * x] * sB + bB;
+            pG[o + x] = row[3 * x + 1] * sG + bG;
+            pR[o + x] = row[3 * x + 2] * sR + bR;
+        }
+    }
+}
+
+void ImagePreprocessor::buildColumnTable(int srcCols) {
+    xofs0_.resize(size_.width);
+    xofs1_.resize(size_.width);
+    xweight_.resize(size_.width);
+    const double fx = static_cast<double>(srcCols) / size_.width;
+    for (int x = 0; x < size_.width; ++x) {
+        // Pusat piksel seperti cv::resize INTER_LINEAR, di-clamp di tepi
+        float sx = static_cast<float>((x + 0.5) * fx - 0.5);
+        int x0 = static_cast<int>(std::floor(sx));
+        float w = sx - x0;
+        if (x0 < 0) {
+            x0 = 0;
+            w = 0.0f;
+        }
+        if (x0 >= srcCols - 1) {
+            x0 = srcCols - 1;
+            w = 0.0f;
+        }
+        xofs0_[x] = 3 * x0;
+        xofs1_[x] = 3 * std::min(x0 + 1, srcCols - 1);
+        xweight_[x] = w;
+    }
+    tableCols_ = srcCols;
+}
+
+void ImagePreprocessor::resizeLinear(const cv::Mat& bgr, float* chw) {
+    if (tableCols_ != bgr.cols) buildColumnTable(bgr.cols);
+    rowBuf_.resize(static_cast<size_t>(bgr.cols) * 3);
+
+    const size_t plane = static_cast<size_t>(size_.area());
+    const int outB = norm_.swapRB ? 2 : 0, outR = norm_.swapRB ? 0 : 2;
+    LinearRow row;
+    row.srcLen = bgr.cols * 3;
+    row.xofs0 = xofs0_.data();
+    row.xofs1 = xofs1_.data();
+    row.xw = xweight_.data();
+    row.width = size_.width;
+    const int outPlane[3] = {outB, 1, outR};
+    for (int c = 0; c < 3; ++c) {
+        row.scale[c] = norm_.scale[outPlane[c]];
+        row.bias[c] = norm_.bias[outPlane[c]];
+    }
+    const LinearRowFn kernel = dispatch().linearRow;
+
+    const double fy = static_cast<double>(bgr.rows) / size_.height;
+    for (int y = 0; y < size_.height; ++y) {
+        float sy = static_cast<float>((y + 0.5) * fy - 0.5);
+        int y0 = static_cast<int>(std::floor(sy));
+        float wy = sy - y0;
+        if (y0 < 0) {
+            y0 = 0;
+            wy = 0.0f;
+        }
+        if (y0 >= bgr.rows - 1) {
+            y0 = bgr.rows - 1;
+            wy = 0.0f;
+        }
+        row.r0 = bgr.ptr<uchar>(y0);
+        row.r1 = bgr.ptr<uchar>(std::min(y0 + 1, bgr.rows - 1));
+        row.wy = wy;
+        const size_t o = static_cast<size_t>(y) * size_.width;
+        for (int c = 0; c < 3; ++c) row.out[c] = chw + outPlane[c] * plane + o;
+        kernel(row, rowBuf_.data());
+    }
+}
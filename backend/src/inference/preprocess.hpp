@@ -0,0 +1,76 @@
+#ifndef PREPROCESS_HPP
+#define PREPROCESS_HPP
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+#include "util/aligned_allocator.hpp"
+
+// Normalisasi per channel output: out[c] = v * scale[c] + bias[c].
+// swapRB: input BGR, output RGB (channel output 0 = R).
+struct NormalizeParams {
+    float scale[3] = {1.0f, 1.0f, 1.0f};
+    float bias[3] = {0.0f, 0.0f, 0.0f};
+    bool swapRB = true;
+
+    // ((v / range) - mean[c]) / std[c], mean/std dalam urutan channel output
+    static NormalizeParams meanStd(const float mean[3], const float std[3], float range = 255.0f,
+                                   bool swapRB = true);
+    static NormalizeParams affine(float scale, float bias, bool swapRB = true);
+};
+
+// Input tensor yang dipakai ulang antar panggilan (64-byte aligned). Hanya
+// tumbuh, jadi setelah request pertama tidak ada alokasi heap lagi.
+class TensorBuffer {
+public:
+    float* reserve(size_t count) {
+        if (data_.size() < count) data_.resize(count);
+        return data_.data();
+    }
+    float* data() { return data_.data(); }
+    size_t capacity() const { return data_.size(); }
+
+private:
+    std::vector<float, AlignedAllocator<float>> data_;
+};
+
+// Resize + BGR->RGB + normalisasi + HWC->CHW dalam satu pass dari gambar
+// CV_8UC3 ke tensor 3 x H x W. INTER_LINEAR di-fuse (koordinat sampling sama
+// dengan cv::resize, tanpa pembulatan ke uchar); interpolasi lain di-resize ke
+// buffer internal yang dipakai ulang lalu dinormalisasi dalam satu pass.
+// Input gray / BGRA dikonversi ke BGR dulu.
+// Jalur linear punya kernel AVX2+FMA (blend vertikal lalu gather horizontal),
+// dipilih sekali saat runtime dari CPUID seperti simd_kernels; fallback skalar.
+// Tidak thread-safe: satu instance per model.
+class ImagePreprocessor {
+public:
+    ImagePreprocessor() = default;
+    ImagePreprocessor(cv::Size size, const NormalizeParams& norm, int interpolation = cv::INTER_LINEAR);
+
+    void configure(cv::Size size, const NormalizeParams& norm, int interpolation = cv::INTER_LINEAR);
+    void run(const cv::Mat& bgr, float* chw);
+
+    cv::Size size() const { return size_; }
+    size_t tensorSize() const { return static_cast<size_t>(3) * size_.area(); }
+    const NormalizeParams& normalize() const { return norm_; }
+    static const char* activeIsa();
+
+private:
+    cv::Size size_;
+    NormalizeParams norm_;
+    int interpolation_ = cv::INTER_LINEAR;
+
+    // Tabel kolom untuk resize linear, dihitung ulang hanya bila lebar input berubah
+    int tableCols_ = -1;
+    std::vector<int> xofs0_, xofs1_;
+    std::vector<float> xweight_;
+    std::vector<float> rowBuf_;   // satu baris sumber hasil blend vertikal (kernel AVX2)
+    cv::Mat resized_;
+    cv::Mat converted_;   // input bukan CV_8UC3 (gray / BGRA)
+
+    void buildColumnTable(int srcCols);
+    void normalizeRows(const cv::Mat& bgr, float* chw) const;
+    void resizeLinear(const cv::Mat& bgr, float* chw);
+};
+
+#endif
@@ -2,20 +2,31 @@
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include <csignal>
+
+static volatile std::sig_atomic_t g_stopRequested = 0;
+
+static void onSignal(int) {
+    g_stopRequested = 1;
+}
 
 int main() {
+    // SIGTERM dari docker stop: keluar dari loop supaya FaceDB sempat checkpoint
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
     FaceRecognitionServer server("http://0.0.0.0:8080");
     try {
         server.start();
         std::cout << "Server running. Press Ctrl+C to stop." << std::endl;
-        // Loop forever
-        while (true) {
-            std::this_thread::sleep_for(std::chrono::seconds(1));
+        while (!g_stopRequested) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
         }
-        // server.stop();
+        std::cout << "Shutting down..." << std::endl;
+        server.stop();
     } catch (std::exception const & e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
     }
     return 0;
-}
\ No newline at end of file
+}
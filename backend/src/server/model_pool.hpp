@@ -0,0 +1,75 @@
+#ifndef MODEL_POOL_HPP
+#define MODEL_POOL_HPP
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Kumpulan instance model (FaceEmbedder, DepthAntiSpoofing, ...) yang tidak
+// aman dipakai bersamaan. Tiap request meminjam satu instance lewat Lease dan
+// mengembalikannya otomatis saat Lease keluar scope. acquire() menunggu bila
+// semua instance sedang dipakai, sehingga jumlah inferensi paralel = size().
+template <typename T>
+class ModelPool {
+public:
+    class Lease {
+    public:
+        Lease(ModelPool* pool, std::unique_ptr<T> item) : pool_(pool), item_(std::move(item)) {}
+        Lease(Lease&& other) noexcept = default;
+        Lease& operator=(Lease&&) = delete;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease() {
+            if (item_) pool_->release(std::move(item_));
+        }
+
+        T* operator->() const { return item_.get(); }
+        T& operator*() const { return *item_; }
+
+    private:
+        ModelPool* pool_;
+        std::unique_ptr<T> item_;
+    };
+
+    ModelPool() = default;
+    ModelPool(const ModelPool&) = delete;
+    ModelPool& operator=(const ModelPool&) = delete;
+
+    void add(std::unique_ptr<T> item) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle_.push_back(std::move(item));
+        ++size_;
+        cv_.notify_one();
+    }
+
+    Lease acquire() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return !idle_.empty(); });
+        std::unique_ptr<T> item = std::move(idle_.back());
+        idle_.pop_back();
+        return Lease(this, std::move(item));
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return size_;
+    }
+    bool empty() const { return size() == 0; }
+
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<std::unique_ptr<T>> idle_;
+    size_t size_ = 0;
+
+    void release(std::unique_ptr<T> item) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            idle_.push_back(std::move(item));
+        }
+        cv_.notify_one();
+    }
+};
+
+#endif
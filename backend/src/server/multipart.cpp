@@ -0,0 +1,94 @@
+#include "multipart.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <functional>
+
+static std::string lower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
+    return s;
+}
+
+// Nilai parameter header, mis. name="image" -> image
+static std::string headerParam(const std::string& header, const std::string& key) {
+    std::string lowerHeader = lower(header);
+    size_t pos = 0;
+    while ((pos = lowerHeader.find(key + "=", pos)) != std::string::npos) {
+        // key harus berdiri sendiri (bukan "filename" saat mencari "name")
+        if (pos == 0 || lowerHeader[pos - 1] == ' ' || lowerHeader[pos - 1] == ';') break;
+        pos += key.size();
+    }
+    if (pos == std::string::npos) return "";
+    pos += key.size() + 1;
+    if (pos < header.size() && header[pos] == '"') {
+        size_t end = header.find('"', pos + 1);
+        return header.substr(pos + 1, end == std::string::npos ? std::string::npos : end - pos - 1);
+    }
+    size_t end = header.find(';', pos);
+    std::string value = header.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+    while (!value.empty() && std::isspace(static_cast<unsigned char>(value.back()))) value.pop_back();
+    return value;
+}
+
+std::string multipartBoundary(const std::string& contentType) {
+    if (lower(contentType).rfind("multipart/form-data", 0) != 0) return "";
+    return headerParam(contentType, "boundary");
+}
+
+bool parseMultipart(const std::vector<unsigned char>& body, const std::string& boundary,
+                    std::vector<MultipartPart>& parts) {
+    parts.clear();
+    if (boundary.empty()) return false;
+
+    const std::string delimiter = "--" + boundary;
+    const std::string nextDelimiter = "\r\n" + delimiter;
+    const std::boyer_moore_horspool_searcher<std::string::const_iterator> searchNext(
+        nextDelimiter.begin(), nextDelimiter.end());
+    const unsigned char* begin = body.data();
+    const unsigned char* end = begin + body.size();
+    auto find = [end](const unsigned char* from, const std::string& needle) {
+        return std::search(from, end, needle.begin(), needle.end());
+    };
+
+    const unsigned char* pos = find(begin, delimiter);
+    if (pos == end) return false;
+    pos += delimiter.size();
+
+    for (;;) {
+        if (end - pos >= 2 && pos[0] == '-' && pos[1] == '-') return true;  // delimiter penutup
+        if (end - pos < 2 || pos[0] != '\r' || pos[1] != '\n') return false;
+        pos += 2;
+
+        const unsigned char* headersEnd = find(pos, "\r\n\r\n");
+        if (headersEnd == end) return false;
+
+        MultipartPart part;
+        std::string headers(reinterpret_cast<const char*>(pos), headersEnd - pos);
+        size_t lineStart = 0;
+        while (lineStart <= headers.size()) {
+            size_t lineEnd = headers.find("\r\n", lineStart);
+            if (lineEnd == std::string::npos) lineEnd = headers.size();
+            std::string line = headers.substr(lineStart, lineEnd - lineStart);
+            size_t colon = line.find(':');
+            if (colon != std::string::npos) {
+                std::string key = lower(line.substr(0, colon));
+                std::string value = line.substr(colon + 1);
+                value.erase(0, value.find_first_not_of(' '));
+                if (key == "content-disposition") {
+                    part.name = headerParam(value, "name");
+                    part.filename = headerParam(value, "filename");
+                } else if (key == "content-type") {
+                    part.contentType = value;
+                }
+            }
+            lineStart = lineEnd + 2;
+        }
+
+        part.data = headersEnd + 4;
+        const unsigned char* partEnd = std::search(part.data, end, searchNext);
+        if (partEnd == end) return false;
+        part.size = static_cast<size_t>(partEnd - part.data);
+        parts.push_back(part);
+        pos = partEnd + nextDelimiter.size();
+    }
+}
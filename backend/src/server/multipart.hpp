@@ -0,0 +1,25 @@
+#ifndef MULTIPART_HPP
+#define MULTIPART_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Satu bagian multipart/form-data. data menunjuk langsung ke body request
+// (tanpa copy), jadi hanya valid selama body masih hidup.
+struct MultipartPart {
+    std::string name;
+    std::string filename;
+    std::string contentType;
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+};
+
+// boundary dari header Content-Type ("multipart/form-data; boundary=..."), kosong bila tidak ada
+std::string multipartBoundary(const std::string& contentType);
+
+// Parse body multipart/form-data (RFC 7578). false bila format rusak.
+bool parseMultipart(const std::vector<unsigned char>& body, const std::string& boundary,
+                    std::vector<MultipartPart>& parts);
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef PIPELINE_CONTEXT_HPP
+#define PIPELINE_CONTEXT_HPP
+
+#include <opencv2/opencv.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// State satu request /register atau /verify. Dibuat per request supaya
+// handler yang berjalan paralel tidak berbagi buffer gambar.
+struct PipelineContext {
+    cv::Mat fullImage;
+    cv::Mat croppedFace;
+    cv::Mat spoofImage;
+    cv::Rect faceArea;
+    std::vector<cv::Point2f> landmarks;  // 5 titik (kosong bila detector Haar)
+    bool debug = false;  // artefak request ini disimpan oleh debugSink()
+    bool enrollment = false;  // registrasi: embedding selalu dihitung ulang, tanpa embed cache
+    float spoofScore = 0.0f;
+    std::vector<float> embedding;
+};
+
+// Request ditolak di salah satu tahap pipeline. stage dilaporkan di response:
+// decode, detection, quality_size, quality_pose, quality_exposure, quality_blur,
+// liveness, embedding
+struct PipelineReject : std::runtime_error {
+    PipelineReject(const std::string& stage, const std::string& message)
+        : std::runtime_error(message), stage(stage) {}
+    std::string stage;
+};
+
+#endif
@@ -1,48 +1,196 @@
 #include "server/server.hpp"
 #include "base64/base64.hpp"
 #include "config/load_config.hpp"
+#include "debug/debug_sink.hpp"
+#include "embedder/face_alignment.hpp"
+#include "server/multipart.hpp"
 #include <fstream>
 #include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <thread>
 
 using namespace web;
 using namespace web::http;
 using namespace web::http::experimental::listener;
 
+// Isi pool dengan `count` instance; berhenti di instance pertama yang gagal load
+template <typename T, typename Loader>
+static void fillPool(ModelPool<T>& pool, int count, const char* what, Loader load) {
+    for (int i = 0; i < count; ++i) {
+        auto model = std::make_unique<T>();
+        if (!load(*model)) {
+            std::cerr << "Failed to load " << what << "!" << std::endl;
+            return;
+        }
+        pool.add(std::move(model));
+    }
+}
+
+// <prefix>_precision = int8: pakai <prefix>_model_int8 bila ada, selain itu model fp32.
+// Model INT8 sebaiknya lolos `model_quant_tool report` dulu.
+static std::string selectModel(const Config& cfg, const std::string& modelKey, const std::string& prefix) {
+    std::string path = cfg.getString(modelKey);
+    if (cfg.getString(prefix + "_precision", "fp32") != "int8") return path;
+    std::string int8Path = cfg.getString(prefix + "_model_int8");
+    if (!int8Path.empty() && std::ifstream(int8Path).good()) {
+        std::cout << "Using INT8 " << prefix << " model: " << int8Path << std::endl;
+        return int8Path;
+    }
+    std::cerr << "INT8 " << prefix << " model not found (" << int8Path << "), using fp32" << std::endl;
+    return path;
+}
+
+static void replyJson(const http_request& request, status_code code, const json::value& body) {
+    http_response response(code);
+    response.headers().add(U("Access-Control-Allow-Origin"), U("*"));
+    response.set_body(body);
+    request.reply(response);
+}
+
+// Penolakan pipeline menyertakan tahap yang menolak ("stage")
+static void replyError(const http_request& request, const std::exception& e) {
+    json::value resp;
+    resp[U("error")] = json::value::string(e.what());
+    if (auto reject = dynamic_cast<const PipelineReject*>(&e)) {
+        resp[U("stage")] = json::value::string(reject->stage);
+    }
+    replyJson(request, status_codes::BadRequest, resp);
+}
+
+// Buffer decode dipakai ulang per thread pplx; hasilnya dibaca langsung oleh imdecode
+static const std::vector<unsigned char>& decodeBase64Image(const std::string& base64Image) {
+    thread_local std::vector<unsigned char> decoded;
+    if (!Base64::decodeInto(base64Image, decoded)) {
+        throw std::runtime_error("Invalid base64 image");
+    }
+    return decoded;
+}
+
+static bool startsWith(const std::string& s, const std::string& prefix) {
+    return s.size() >= prefix.size() && std::equal(prefix.begin(), prefix.end(), s.begin(),
+        [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == b; });
+}
+
 FaceRecognitionServer::FaceRecognitionServer(const std::string& address) 
-:   listener(address),
-    detector_(std::make_unique<FaceDetector>()),
-    embedder_(std::make_unique<FaceEmbedder>()),
-    db_(std::make_unique<FaceDB>("/app/data/face_db.bin")),
+:   listener(address)
     // anti_spoof_(std::make_unique<AntiSpoofing>("/app/models/anti_spoof/mobilenetv2_model2.onnx")),
-    depth_(std::make_unique<DepthAntiSpoofing>())
 {
     try
     {
         Config cfg("/app/config.txt");
-        // Load models with proper error checking
-        if (!detector_->loadCascade(cfg.getString("face_detection_model"))) {
-            std::cerr << "Failed to load face detector!" << std::endl;
-            detector_.reset();
-        }
+        debugSink().start(DebugSinkOptions::fromConfig(cfg));
+        // Tiap worker memakai instance model sendiri, jumlah request paralel = workers
+        int workers = std::max(1, cfg.getInt("pipeline_workers", 2));
+        // Default thread ORT per instance: core dibagi rata antar worker
+        int threadsPerWorker = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) / workers);
+        InferenceOptions embedderOptions = InferenceOptions::fromConfig(cfg, "embedder", threadsPerWorker);
+        InferenceOptions depthOptions = InferenceOptions::fromConfig(cfg, "depth", threadsPerWorker);
+        std::string embedderModel = selectModel(cfg, "embedder_model", "embedder");
+        std::string depthModel = selectModel(cfg, "depth_estimation_model", "depth");
 
-        if (!embedder_->loadModel(cfg.getString("embedder_model"))) {
-            std::cerr << "Failed to load face embedder!" << std::endl;
-            embedder_.reset();
-        }
-
-        if (!depth_->LoadModel(cfg.getString("depth_estimation_model"), cfg.getFloat("spoof_threshold", 0.5f))){
-            std::cerr << "Failed to load depth anything!" << std::endl;
-            depth_.reset();
-        }
+        // Load models with proper error checking
+        DetectorOptions detectorOptions = DetectorOptions::fromConfig(cfg);
+        fillPool(detectors_, workers, "face detector", [&](FaceDetector& d) {
+            return d.load(detectorOptions);
+        });
+        // Alignment 5 titik mengubah ruang embedding, jadi default mati: galeri yang
+        // terdaftar tanpa alignment harus diregistrasi ulang sebelum diaktifkan
+        bool alignFaces = cfg.getInt("face_alignment", 0) != 0;
+        fillPool(embedders_, workers, "face embedder", [&](FaceEmbedder& e) {
+            e.setAlignment(alignFaces);
+            return e.loadModel(embedderModel, embedderOptions);
+        });
+        embedCache_.configure(EmbeddingCacheOptions::fromConfig(cfg, alignFaces));
+        // Threshold stddev bergantung pada mode input, kalibrasi dengan `bench depth`
+        DepthInputMode depthMode = parseDepthInputMode(cfg.getString("depth_input_mode", "full"));
+        float spoofThreshold = depthMode == DepthInputMode::Roi
+            ? cfg.getFloat("spoof_threshold_roi", cfg.getFloat("spoof_threshold", 0.5f))
+            : cfg.getFloat("spoof_threshold", 0.5f);
+        fillPool(depths_, workers, "depth anything", [&](DepthAntiSpoofing& d) {
+            if (!d.LoadModel(depthModel, spoofThreshold, depthOptions)) return false;
+            d.setInputMode(depthMode, cfg.getFloat("depth_roi_padding", 0.5f));
+            return true;
+        });
+
+        FaceDBOptions dbOptions;
+        dbOptions.index = cfg.getString("db_index", "flat");
+        dbOptions.hnsw.M = cfg.getInt("hnsw_m", dbOptions.hnsw.M);
+        dbOptions.hnsw.efConstruction = cfg.getInt("hnsw_ef_construction", dbOptions.hnsw.efConstruction);
+        dbOptions.hnsw.efSearch = cfg.getInt("hnsw_ef_search", dbOptions.hnsw.efSearch);
+        dbOptions.storage = parseStorageMode(cfg.getString("db_storage", "float"));
+        dbOptions.rerankK = cfg.getInt("db_rerank_k", dbOptions.rerankK);
+        dbOptions.selfCheckQueries = cfg.getInt("db_selfcheck_queries", 0);
+        dbOptions.gallery = cfg.getString("db_gallery", dbOptions.gallery);
+        dbOptions.centroidOutlierSigma = cfg.getFloat("centroid_outlier_sigma", dbOptions.centroidOutlierSigma);
+        dbOptions.centroidFallbackMargin = cfg.getFloat("centroid_fallback_margin", dbOptions.centroidFallbackMargin);
+        dbOptions.wal = cfg.getInt("wal_enabled", 1) != 0;
+        dbOptions.walGroupCommitUs = cfg.getInt("wal_group_commit_us", dbOptions.walGroupCommitUs);
+        dbOptions.compactIntervalSec = cfg.getInt("wal_compact_interval_sec", dbOptions.compactIntervalSec);
+        dbOptions.compactBytes = static_cast<size_t>(
+            cfg.getInt("wal_compact_bytes", static_cast<int>(dbOptions.compactBytes)));
+        dbOptions.parallelScanMinRows = static_cast<size_t>(
+            std::max(0, cfg.getInt("db_parallel_scan_min_rows", static_cast<int>(dbOptions.parallelScanMinRows))));
+        dbOptions.scanShardBytes = static_cast<size_t>(std::max(16, cfg.getInt("db_scan_shard_kb", 1024))) * 1024;
+        dbOptions.parallelScanThreads = cfg.getInt("db_parallel_scan_threads", 0);
+        db_ = std::make_unique<FaceDB>(cfg.getString("data_store", "/app/data/face_db.bin"), dbOptions);
 
         listener.support(methods::GET, std::bind(&FaceRecognitionServer::handleGet, this, std::placeholders::_1));
         listener.support(methods::POST, std::bind(&FaceRecognitionServer::handlePost, this, std::placeholders::_1));
         listener.support(methods::OPTIONS, std::bind(&FaceRecognitionServer::handleOptions, this, std::placeholders::_1));
 
-        std::cout << "Detector loaded: " << (detector_ ? "yes" : "no") << std::endl;
-        std::cout << "Embedder loaded: " << (embedder_ ? "yes" : "no") << std::endl;
+        // Request paralel digabung jadi satu forward pass (maks batch_max_size / batch_max_wait_us)
+        size_t batchMax = static_cast<size_t>(std::max(1, cfg.getInt("batch_max_size", 8)));
+        std::chrono::microseconds batchWait(std::max(0, cfg.getInt("batch_max_wait_us", 2000)));
+        if (!embedders_.empty()) {
+            bool embedBatch;
+            {
+                auto embedder = embedders_.acquire();
+                embedBatch = embedder->supportsBatch();
+            }
+            // arcfaceresnet100-8 bawaan static batch 1: tanpa export dinamis, item
+            // tidak ditahan menunggu batch yang toh dijalankan satu per satu
+            embedBatcher_.start([this](const std::vector<FaceInput>& faces) {
+                auto embedder = embedders_.acquire();
+                return embedder->getNormalizedEmbeddings(faces);
+            }, embedders_.size(), embedBatch ? batchMax : 1, batchWait);
+        }
+        if (!depths_.empty()) {
+            bool depthBatch;
+            {
+                auto depth = depths_.acquire();
+                depthBatch = depth->supportsBatch();
+            }
+            // Model static (batch 1) tidak untung dari batching, hanya menambah latency
+            depthBatcher_.start([this](const std::vector<DepthRequest>& requests) {
+                auto depth = depths_.acquire();
+                return depth->isSpoofBatch(requests);
+            }, depths_.size(), depthBatch ? batchMax : 1, batchWait);
+        }
 
-        full_image_ = cv::Mat::zeros(cv::Size(640, 480), CV_8UC1);
+        batchPool_.start(static_cast<size_t>(std::max(1, cfg.getInt("batch_api_threads", workers * 4))));
+        db_->setScanPool(&batchPool_);
+        batchMaxItems_ = static_cast<size_t>(std::max(1, cfg.getInt("batch_api_max_items", 256)));
+        matchThreshold_ = cfg.getFloat("face_threshold", matchThreshold_);
+        searchMaxK_ = static_cast<size_t>(std::max(1, cfg.getInt("search_max_k", 50)));
+        streams_.configure(StreamOptions::fromConfig(cfg, spoofThreshold));
+        // Gate murah sebelum depth + embedding, urutan dari quality_gates
+        qualityGate_ = FaceQualityGate(QualityParams::fromConfig(cfg));
+        parallelLiveness_ = cfg.getInt("pipeline_parallel_liveness", 0) != 0;
+
+        std::cout << "Detector instances: " << detectors_.size();
+        if (!detectors_.empty()) std::cout << " (" << detectors_.acquire()->backendName() << ")";
+        std::cout << std::endl;
+        std::cout << "Embedder instances: " << embedders_.size();
+        if (embedCache_.enabled()) std::cout << " (cache " << embedCache_.stats().capacity << " entries)";
+        std::cout << std::endl;
+        std::cout << "Depth instances: " << depths_.size() << std::endl;
+        std::cout << "Quality gates:";
+        for (QualityGate gate : qualityGate_.params().gates) std::cout << " " << qualityGateName(gate);
+        if (!qualityGate_.enabled()) std::cout << " none";
+        std::cout << (parallelLiveness_ ? ", liveness || embedding" : "") << std::endl;
     }
     catch(const std::exception& e)
     {
@@ -59,6 +207,8 @@ void FaceRecognitionServer::handleGet(http_request request) {
         response.headers().add(U("Access-Control-Allow-Origin"), U("*"));
         response.set_body(U("Backend is running"));
         request.reply(response);
+    } else if (path == U("/stats")) {
+        handleStats(request);
     } else {
         request.reply(status_codes::NotFound);
     }
@@ -67,22 +217,40 @@ void FaceRecognitionServer::handleGet(http_request request) {
 void FaceRecognitionServer::handlePost(http_request request) {
     auto path = request.request_uri().path();
     if (path == U("/test")) {
-        request.extract_json().then([this, request](json::value body) {
-            auto imageBase64 = body.at(U("image")).as_string();
-            this->processImage(imageBase64);
-            
-            http_response response(status_codes::OK);
-            response.headers().add(U("Access-Control-Allow-Origin"), U("*"));
-            json::value resp;
-            resp[U("status")] = json::value::string(U("received"));
-            resp[U("image_size")] = json::value::number(imageBase64.size());
-            response.set_body(resp);
-            request.reply(response);
-        }).wait();
+        request.extract_json().then([this, request](pplx::task<json::value> task) {
+            try {
+                json::value body = task.get();
+                const auto& imageBase64 = body.at(U("image")).as_string();
+                this->processImage(imageBase64);
+
+                json::value resp;
+                resp[U("status")] = json::value::string(U("received"));
+                resp[U("image_size")] = json::value::number(imageBase64.size());
+                replyJson(request, status_codes::OK, resp);
+            } catch (const std::exception& e) {
+                replyError(request, e);
+            }
+        });
     } else if (path == U("/register")) {
         handleRegister(request);
     } else if (path == U("/verify")) {
         handleVerify(request);
+    } else if (path == U("/v2/register")) {
+        handleUpload(request, true);
+    } else if (path == U("/v2/verify")) {
+        handleUpload(request, false);
+    } else if (path == U("/search")) {
+        handleSearch(request);
+    } else if (path == U("/batch/register")) {
+        handleBatch(request, true);
+    } else if (path == U("/batch/verify")) {
+        handleBatch(request, false);
+    } else if (path == U("/stream/start")) {
+        handleStream(request, "start");
+    } else if (path == U("/stream/frame")) {
+        handleStream(request, "frame");
+    } else if (path == U("/stream/end")) {
+        handleStream(request, "end");
     } else {
         request.reply(status_codes::NotFound);
     }
@@ -96,71 +264,488 @@ void FaceRecognitionServer::handleOptions(http_request request) {
     request.reply(response);
 }
 
+// Handler tidak menunggu (.wait()) di thread listener: pipeline berjalan di
+// continuation pada thread pool pplx, paralelisme dibatasi oleh ModelPool.
 void FaceRecognitionServer::handleRegister(http_request request) {
-    request.extract_json().then([this, request](json::value body) {
-        auto name = body.at(U("name")).as_string();
-        auto imageBase64 = body.at(U("image")).as_string();
-        
+    request.extract_json().then([this, request](pplx::task<json::value> task) {
         try {
-            this->registerFace(name, imageBase64);
-            
-            http_response response(status_codes::OK);
-            response.headers().add(U("Access-Control-Allow-Origin"), U("*"));
+            json::value body = task.get();
+            auto name = body.at(U("name")).as_string();
+            const auto& imageBase64 = body.at(U("image")).as_string();
+
+            const auto& image = decodeBase64Image(imageBase64);
+            this->registerFace(name, image.data(), image.size());
+
             json::value resp;
             resp[U("status")] = json::value::string(U("registered"));
             resp[U("name")] = json::value::string(name);
-            response.set_body(resp);
-            request.reply(response);
+            replyJson(request, status_codes::OK, resp);
         } catch (const std::exception& e) {
-            http_response response(status_codes::BadRequest);
-            response.headers().add(U("Access-Control-Allow-Origin"), U("*"));
-            json::value resp;
-            resp[U("error")] = json::value::string(e.what());
-            response.set_body(resp);
-            request.reply(response);
+            replyError(request, e);
         }
-    }).wait();
+    });
 }
 
 void FaceRecognitionServer::handleVerify(http_request request) {
-    request.extract_json().then([this, request](json::value body) {
-        auto imageBase64 = body.at(U("image")).as_string();
-        
-        std::string name;
-        float confidence;
+    request.extract_json().then([this, request](pplx::task<json::value> task) {
         try {
-            this->verifyFace(imageBase64, name, confidence);
-            
-            http_response response(status_codes::OK);
-            response.headers().add(U("Access-Control-Allow-Origin"), U("*"));
+            json::value body = task.get();
+            const auto& imageBase64 = body.at(U("image")).as_string();
+            // Opsional: "claim" = nama yang diklaim, verifikasi 1:1
+            std::string claim = body.has_string_field(U("claim")) ? body.at(U("claim")).as_string() : "";
+
+            std::string name;
+            float confidence;
+            const auto& image = decodeBase64Image(imageBase64);
+            this->verifyFace(image.data(), image.size(), claim, name, confidence);
+
             json::value resp;
             resp[U("status")] = json::value::string(U("verified"));
             resp[U("name")] = json::value::string(name);
             resp[U("confidence")] = json::value::number(confidence);
-            response.set_body(resp);
-            request.reply(response);
+            resp[U("mode")] = json::value::string(claim.empty() ? U("1:N") : U("1:1"));
+            replyJson(request, status_codes::OK, resp);
+        } catch (const std::exception& e) {
+            replyError(request, e);
+        }
+    });
+}
+
+// /v2/register dan /v2/verify: body berupa file gambar (image/jpeg, image/png,
+// application/octet-stream) atau multipart/form-data dengan part "image"
+// (dan "name" untuk register). Tanpa JSON dan base64; nama juga bisa lewat ?name=.
+void FaceRecognitionServer::handleUpload(http_request request, bool registering) {
+    request.extract_vector().then([this, request, registering](pplx::task<std::vector<unsigned char>> task) {
+        try {
+            std::vector<unsigned char> body = task.get();
+            const std::string contentType = request.headers().content_type();
+
+            auto query = uri::split_query(request.request_uri().query());
+            std::string name = query.count(U("name")) ? uri::decode(query[U("name")]) : "";
+            std::string claim = query.count(U("claim")) ? uri::decode(query[U("claim")]) : "";
+            const unsigned char* image = nullptr;
+            size_t imageSize = 0;
+
+            if (startsWith(contentType, "multipart/form-data")) {
+                std::vector<MultipartPart> parts;
+                if (!parseMultipart(body, multipartBoundary(contentType), parts)) {
+                    throw std::runtime_error("Malformed multipart body");
+                }
+                for (const auto& part : parts) {
+                    if (part.name == "image") {
+                        image = part.data;
+                        imageSize = part.size;
+                    } else if (part.name == "name") {
+                        name.assign(reinterpret_cast<const char*>(part.data), part.size);
+                    } else if (part.name == "claim") {
+                        claim.assign(reinterpret_cast<const char*>(part.data), part.size);
+                    }
+                }
+            } else if (startsWith(contentType, "image/") || startsWith(contentType, "application/octet-stream")) {
+                image = body.data();
+                imageSize = body.size();
+            } else {
+                json::value resp;
+                resp[U("error")] = json::value::string("Unsupported Content-Type: " + contentType);
+                replyJson(request, status_codes::UnsupportedMediaType, resp);
+                return;
+            }
+            if (imageSize == 0) {
+                throw std::runtime_error("Missing image");
+            }
+
+            json::value resp;
+            if (registering) {
+                if (name.empty()) {
+                    throw std::runtime_error("Missing name");
+                }
+                this->registerFace(name, image, imageSize);
+                resp[U("status")] = json::value::string(U("registered"));
+                resp[U("name")] = json::value::string(name);
+            } else {
+                float confidence;
+                this->verifyFace(image, imageSize, claim, name, confidence);
+                resp[U("status")] = json::value::string(U("verified"));
+                resp[U("name")] = json::value::string(name);
+                resp[U("confidence")] = json::value::number(confidence);
+                resp[U("mode")] = json::value::string(claim.empty() ? U("1:N") : U("1:1"));
+            }
+            replyJson(request, status_codes::OK, resp);
+        } catch (const std::exception& e) {
+            replyError(request, e);
+        }
+    });
+}
+
+// Body: {"image": "<base64>", "k": 5}. Response: {"matches": [{"id", "name", "score"}]}
+// terurut dari skor tertinggi, hanya skor >= face_threshold.
+void FaceRecognitionServer::handleSearch(http_request request) {
+    request.extract_json().then([this, request](pplx::task<json::value> task) {
+        try {
+            json::value body = task.get();
+            const auto& image = decodeBase64Image(body.at(U("image")).as_string());
+            int k = body.has_number_field(U("k")) ? body.at(U("k")).as_integer() : 5;
+            k = std::max(1, std::min(k, static_cast<int>(searchMaxK_)));
+
+            PipelineContext ctx;
+            runPipeline(image.data(), image.size(), ctx, "search");
+            std::vector<FaceMatch> matches = db_->search(ctx.embedding, static_cast<size_t>(k), matchThreshold_);
+
+            json::value list = json::value::array(matches.size());
+            for (size_t i = 0; i < matches.size(); ++i) {
+                json::value m;
+                m[U("id")] = json::value::string(matches[i].id);
+                m[U("name")] = json::value::string(matches[i].name);
+                m[U("score")] = json::value::number(matches[i].score);
+                list[i] = m;
+            }
+            json::value resp;
+            resp[U("status")] = json::value::string(U("ok"));
+            resp[U("matches")] = list;
+            replyJson(request, status_codes::OK, resp);
+        } catch (const std::exception& e) {
+            replyError(request, e);
+        }
+    });
+}
+
+// Body: {"items": [{"name": "...", "image": "<base64>"}, ...]} ("name" hanya untuk register).
+// Pipeline tiap item berjalan paralel di batchPool_; register menyimpan semua
+// wajah yang lolos dengan satu FaceDB::addBatch (satu lock + satu fsync WAL).
+// Response: {"results": [{"index", "status" | "error", ...}], "succeeded", "failed"}
+void FaceRecognitionServer::handleBatch(http_request request, bool registering) {
+    request.extract_json().then([this, request, registering](pplx::task<json::value> task) {
+        try {
+            json::value body = task.get();
+            const auto& items = body.at(U("items")).as_array();
+            if (items.size() > batchMaxItems_) {
+                throw std::runtime_error("Too many items (max " + std::to_string(batchMaxItems_) + ")");
+            }
+
+            const size_t count = items.size();
+            std::vector<std::string> names(count), errors(count), stages(count);
+            std::vector<std::future<std::vector<float>>> jobs(count);
+            for (size_t i = 0; i < count; ++i) {
+                const json::value& item = items.at(i);
+                try {
+                    if (registering) {
+                        names[i] = item.at(U("name")).as_string();
+                        if (names[i].empty()) throw std::runtime_error("Missing name");
+                    }
+                    // Item tetap hidup (body milik continuation ini) sampai semua job selesai
+                    const utility::string_t* image = &item.at(U("image")).as_string();
+                    jobs[i] = batchPool_.submit([this, image, registering]() {
+                        const auto& encoded = decodeBase64Image(*image);
+                        PipelineContext ctx;
+                        ctx.enrollment = registering;
+                        runPipeline(encoded.data(), encoded.size(), ctx, "batch");
+                        return std::move(ctx.embedding);
+                    });
+                } catch (const std::exception& e) {
+                    errors[i] = e.what();
+                }
+            }
+
+            std::vector<std::vector<float>> embeddings(count);
+            for (size_t i = 0; i < count; ++i) {
+                if (!jobs[i].valid()) continue;
+                try {
+                    embeddings[i] = jobs[i].get();
+                } catch (const PipelineReject& e) {
+                    errors[i] = e.what();
+                    stages[i] = e.stage;
+                } catch (const std::exception& e) {
+                    errors[i] = e.what();
+                }
+            }
+
+            json::value results = json::value::array(count);
+            size_t succeeded = 0;
+            if (registering) {
+                std::vector<size_t> accepted;
+                std::vector<std::string> acceptedNames;
+                std::vector<std::vector<float>> acceptedEmbeddings;
+                for (size_t i = 0; i < count; ++i) {
+                    if (!errors[i].empty()) continue;
+                    accepted.push_back(i);
+                    acceptedNames.push_back(names[i]);
+                    acceptedEmbeddings.push_back(std::move(embeddings[i]));
+                }
+                size_t stored = 0;
+                try {
+                    stored = db_->addBatch(acceptedNames, acceptedEmbeddings);
+                } catch (const std::exception& e) {
+                    for (size_t i : accepted) errors[i] = e.what();
+                }
+                for (size_t k = stored; k < accepted.size(); ++k) {
+                    if (errors[accepted[k]].empty()) errors[accepted[k]] = "Failed to store face";
+                }
+                for (size_t i = 0; i < count; ++i) {
+                    json::value r;
+                    r[U("index")] = json::value::number(static_cast<int>(i));
+                    if (errors[i].empty()) {
+                        r[U("status")] = json::value::string(U("registered"));
+                        r[U("name")] = json::value::string(names[i]);
+                        ++succeeded;
+                    } else {
+                        r[U("error")] = json::value::string(errors[i]);
+                        if (!stages[i].empty()) r[U("stage")] = json::value::string(stages[i]);
+                    }
+                    results[i] = r;
+                }
+            } else {
+                for (size_t i = 0; i < count; ++i) {
+                    json::value r;
+                    r[U("index")] = json::value::number(static_cast<int>(i));
+                    if (errors[i].empty()) {
+                        std::pair<std::string, float> match = db_->find(embeddings[i], matchThreshold_);
+                        r[U("status")] = json::value::string(U("verified"));
+                        r[U("name")] = json::value::string(match.first);
+                        r[U("confidence")] = json::value::number(match.second);
+                        ++succeeded;
+                    } else {
+                        r[U("error")] = json::value::string(errors[i]);
+                        if (!stages[i].empty()) r[U("stage")] = json::value::string(stages[i]);
+                    }
+                    results[i] = r;
+                }
+            }
+            std::cout << "Batch " << (registering ? "register" : "verify") << ": " << succeeded << "/"
+                      << count << " ok" << std::endl;
+
+            json::value resp;
+            resp[U("results")] = results;
+            resp[U("succeeded")] = json::value::number(static_cast<int>(succeeded));
+            resp[U("failed")] = json::value::number(static_cast<int>(count - succeeded));
+            replyJson(request, status_codes::OK, resp);
         } catch (const std::exception& e) {
-            http_response response(status_codes::BadRequest);
-            response.headers().add(U("Access-Control-Allow-Origin"), U("*"));
+            replyError(request, e);
+        }
+    });
+}
+
+// /stream/start[?claim=nama] -> {"session": id}; /stream/frame?session=id dengan body
+// file gambar (seperti /v2) -> hasil frame; /stream/end?session=id -> ringkasan sesi.
+// Deteksi + tracking berjalan tiap frame, depth + embedding + pencarian galeri hanya
+// untuk track baru atau setelah stream_refresh_frames / stream_refresh_ms.
+void FaceRecognitionServer::handleStream(http_request request, const std::string& action) {
+    request.extract_vector().then([this, request, action](pplx::task<std::vector<unsigned char>> task) {
+        try {
+            std::vector<unsigned char> body = task.get();
+            auto query = uri::split_query(request.request_uri().query());
+            std::string id = query.count(U("session")) ? uri::decode(query[U("session")]) : "";
+
             json::value resp;
-            resp[U("error")] = json::value::string(e.what());
-            response.set_body(resp);
-            request.reply(response);
+            if (action == "start") {
+                std::string claim = query.count(U("claim")) ? uri::decode(query[U("claim")]) : "";
+                std::shared_ptr<StreamSession> session = streams_.create(claim);
+                if (!session) {
+                    resp[U("error")] = json::value::string(U("Too many stream sessions"));
+                    replyJson(request, status_codes::ServiceUnavailable, resp);
+                    return;
+                }
+                std::cout << "[Stream] Session " << session->id << " started"
+                          << (claim.empty() ? "" : " (claim: " + claim + ")") << std::endl;
+                const StreamOptions& options = streams_.options();
+                resp[U("session")] = json::value::string(session->id);
+                resp[U("refresh_frames")] = json::value::number(options.refreshFrames);
+                resp[U("refresh_ms")] = json::value::number(options.refreshMs);
+                resp[U("ttl_sec")] = json::value::number(options.sessionTtlSec);
+            } else {
+                std::shared_ptr<StreamSession> session =
+                    action == "end" ? streams_.remove(id) : streams_.get(id);
+                if (!session) {
+                    resp[U("error")] = json::value::string(U("Unknown or expired session"));
+                    replyJson(request, status_codes::NotFound, resp);
+                    return;
+                }
+                if (action == "end") {
+                    std::lock_guard<std::mutex> lock(session->mutex);
+                    std::cout << "[Stream] Session " << session->id << " ended: " << session->frames
+                              << " frames, " << session->analyses << " analyses" << std::endl;
+                    resp[U("status")] = json::value::string(U("ended"));
+                    resp[U("frames")] = json::value::number(session->frames);
+                    resp[U("analyses")] = json::value::number(session->analyses);
+                } else {
+                    if (body.empty()) {
+                        throw std::runtime_error("Missing image");
+                    }
+                    resp = streamFrame(*session, body.data(), body.size());
+                }
+            }
+            replyJson(request, status_codes::OK, resp);
+        } catch (const std::exception& e) {
+            replyError(request, e);
+        }
+    });
+}
+
+json::value FaceRecognitionServer::streamFrame(StreamSession& session, const unsigned char* image, size_t imageSize) {
+    if (detectors_.empty() || !embedBatcher_.running() || !depthBatcher_.running() || !db_) {
+        throw std::runtime_error("Required components not loaded");
+    }
+
+    cv::Mat encoded(1, static_cast<int>(imageSize), CV_8UC1, const_cast<unsigned char*>(image));
+    cv::Mat frame = cv::imdecode(encoded, cv::IMREAD_COLOR);
+    if (frame.empty()) {
+        throw std::runtime_error("Image empty");
+    }
+
+    // Deteksi di luar lock sesi; tanpa crop / clone seperti cropFace
+    FaceDetection face;
+    {
+        auto detector = detectors_.acquire();
+        face = detector->getLargestDetection(frame);
+    }
+    face.box &= cv::Rect(0, 0, frame.cols, frame.rows);
+
+    std::lock_guard<std::mutex> lock(session.mutex);
+    ++session.frames;
+    json::value resp;
+    resp[U("session")] = json::value::string(session.id);
+    if (face.box.empty()) {
+        session.tracker.miss();
+        resp[U("status")] = json::value::string(U("no_face"));
+        return resp;
+    }
+
+    if (!session.tracker.update(face.box)) {
+        session.liveness.reset();
+    }
+    auto now = StreamClock::now();
+    bool cached = session.resultFresh(streams_.options(), now);
+    StreamResult& result = session.result;
+    if (cached) {
+        ++result.reused;
+    } else {
+        // Frame buruk tidak masuk analisis (dan tidak dihitung jendela liveness)
+        QualityResult quality = qualityGate_.check(frame, face.box, face.landmarks);
+        if (!quality.ok) {
+            resp[U("status")] = json::value::string(U("rejected"));
+            resp[U("stage")] = json::value::string(qualityGateName(quality.gate));
+            resp[U("error")] = json::value::string(quality.reason());
+            resp[U("track_id")] = json::value::number(session.tracker.trackId());
+            return resp;
         }
-    }).wait();
+
+        // Track baru atau refresh: tahap mahal dijalankan lewat batcher yang sama dengan /verify
+        bool spoof;
+        float spoofScore;
+        if (streams_.options().temporalLiveness) {
+            // Cue gerak tiap frame, depth hanya pada frame yang diminta jendela
+            TemporalLiveness& liveness = session.liveness;
+            liveness.observe(frame, face.box, face.landmarks);
+            if (liveness.wantsDepth()) {
+                liveness.addDepth(depthBatcher_.run(DepthRequest{frame, face.box, debugSink().sample()}).stddev);
+            }
+            LivenessDecision decision = liveness.decision();
+            if (decision == LivenessDecision::Pending) {
+                // Refresh pada track yang sama: hasil lama tetap dipakai sampai jendela baru selesai
+                cached = result.valid && result.trackId == session.tracker.trackId();
+                if (!cached) {
+                    resp[U("status")] = json::value::string(U("pending"));
+                    resp[U("track_id")] = json::value::number(session.tracker.trackId());
+                    resp[U("liveness_frames")] = json::value::number(liveness.frames());
+                    return resp;
+                }
+                ++result.reused;
+            }
+            spoof = decision == LivenessDecision::Spoof;
+            spoofScore = liveness.depthScore();
+            if (decision != LivenessDecision::Pending) {
+                std::cout << "[Stream] Session " << session.id << " track " << session.tracker.trackId()
+                          << (spoof ? " SPOOF " : " LIVE ") << liveness.describe() << std::endl;
+                liveness.reset();
+            }
+        } else {
+            DepthCheck check = depthBatcher_.run(DepthRequest{frame, face.box, debugSink().sample()});
+            spoof = check.spoof;
+            spoofScore = check.stddev;
+        }
+
+        if (!cached) {
+            result = StreamResult();
+            result.trackId = session.tracker.trackId();
+            result.at = now;
+            result.spoof = spoof;
+            result.spoofScore = spoofScore;
+            if (!result.spoof) {
+                std::vector<float> embedding = embedFace(FaceInput{frame, face.box, face.landmarks});
+                if (embedding.empty()) {
+                    throw std::runtime_error("Embedding empty");
+                }
+                matchFace(embedding, session.claim, result.name, result.confidence);
+            }
+            result.valid = true;
+            ++session.analyses;
+        }
+    }
+
+    json::value box;
+    box[U("x")] = json::value::number(face.box.x);
+    box[U("y")] = json::value::number(face.box.y);
+    box[U("width")] = json::value::number(face.box.width);
+    box[U("height")] = json::value::number(face.box.height);
+    resp[U("status")] = json::value::string(result.spoof ? U("spoof") : U("verified"));
+    resp[U("name")] = json::value::string(result.name);
+    resp[U("confidence")] = json::value::number(result.confidence);
+    resp[U("spoof_score")] = json::value::number(result.spoofScore);
+    resp[U("mode")] = json::value::string(session.claim.empty() ? U("1:N") : U("1:1"));
+    resp[U("track_id")] = json::value::number(result.trackId);
+    resp[U("cached")] = json::value::boolean(cached);
+    resp[U("face")] = box;
+    return resp;
+}
+
+template <typename Batcher>
+static json::value batcherStats(const Batcher& batcher) {
+    auto stats = batcher.stats();
+    json::value v;
+    v[U("batches")] = json::value::number(stats.batches);
+    v[U("items")] = json::value::number(stats.items);
+    v[U("largest_batch")] = json::value::number(static_cast<uint64_t>(stats.largestBatch));
+    v[U("cancelled")] = json::value::number(stats.cancelled);
+    return v;
+}
+
+void FaceRecognitionServer::handleStats(http_request request) {
+    EmbeddingCache::Stats cache = embedCache_.stats();
+    json::value cacheJson;
+    cacheJson[U("enabled")] = json::value::boolean(embedCache_.enabled());
+    cacheJson[U("hits")] = json::value::number(cache.hits);
+    cacheJson[U("misses")] = json::value::number(cache.misses);
+    cacheJson[U("expired")] = json::value::number(cache.expired);
+    cacheJson[U("evictions")] = json::value::number(cache.evictions);
+    cacheJson[U("size")] = json::value::number(static_cast<uint64_t>(cache.size));
+    cacheJson[U("capacity")] = json::value::number(static_cast<uint64_t>(cache.capacity));
+
+    DebugSink::Stats debug = debugSink().stats();
+    json::value debugJson;
+    debugJson[U("written")] = json::value::number(debug.written);
+    debugJson[U("dropped")] = json::value::number(debug.dropped);
+
+    json::value resp;
+    resp[U("embed_cache")] = cacheJson;
+    resp[U("embed_batcher")] = batcherStats(embedBatcher_);
+    resp[U("depth_batcher")] = batcherStats(depthBatcher_);
+    resp[U("stream_sessions")] = json::value::number(static_cast<uint64_t>(streams_.size()));
+    resp[U("debug")] = debugJson;
+    replyJson(request, status_codes::OK, resp);
 }
 
 void FaceRecognitionServer::processImage(const std::string& base64Image) {
-    std::ofstream txtfile("/app/data/received_image.txt");
-    txtfile << base64Image;
-    txtfile.close();
+    if (!debugSink().enabled()) {
+        std::cout << "Debug sink disabled (debug_enabled = 0), image not saved" << std::endl;
+        return;
+    }
+    debugSink().text("received_image.txt", base64Image);
 
     try {
         std::vector<unsigned char> decoded = Base64::decode(base64Image);
         cv::Mat img = cv::imdecode(decoded, cv::IMREAD_COLOR);
         if (!img.empty()) {
-            cv::imwrite("/app/data/received_image.jpg", img);
-            std::cout << "Gambar tersimpan: /app/data/received_image.jpg" << std::endl;
+            debugSink().image("received_image.jpg", img);
+            std::cout << "Gambar diantrekan: received_image.jpg" << std::endl;
         } else {
             std::cout << "Gambar kosong setelah decode" << std::endl;
         }
@@ -169,106 +754,148 @@ void FaceRecognitionServer::processImage(const std::string& base64Image) {
     }
 }
 
-void FaceRecognitionServer::registerFace(const std::string& name, const std::string& base64Image) {
-    std::cout << "Register face for: " << name << std::endl;
-    try {
-        if (!detector_ || !embedder_ || !db_ || !depth_) {
-            throw std::runtime_error("Required components not loaded");
-        }
-        
-        std::vector<unsigned char> decoded = Base64::decode(base64Image);
-        full_image_ = cv::imdecode(decoded, cv::IMREAD_COLOR);
-        if (full_image_.empty()) {
-            throw std::runtime_error("Image empty");
-        }
-        detector_->cropFace(full_image_, cropped_face_image_, spoof_detection_image_, faceArea_);
-        if (cropped_face_image_.empty()) {
-            throw std::runtime_error("No face detected");
-        }
+void FaceRecognitionServer::runPipeline(const unsigned char* image, size_t imageSize, PipelineContext& ctx,
+                                        const char* tag) {
+    if (detectors_.empty() || !embedBatcher_.running() || !depthBatcher_.running() || !db_) {
+        throw std::runtime_error("Required components not loaded");
+    }
 
-        if (faceArea_.empty()) {
-            throw std::runtime_error("No Rect");
-        }
+    // Mat header di atas buffer pemanggil, tanpa copy
+    cv::Mat encoded(1, static_cast<int>(imageSize), CV_8UC1, const_cast<unsigned char*>(image));
+    ctx.fullImage = cv::imdecode(encoded, cv::IMREAD_COLOR);
+    if (ctx.fullImage.empty()) {
+        throw PipelineReject("decode", "Image empty");
+    }
 
-        std::cout << "Face Area : " << faceArea_ << std::endl;
+    {
+        auto detector = detectors_.acquire();
+        detector->cropFace(ctx.fullImage, ctx.croppedFace, ctx.spoofImage, ctx.faceArea, &ctx.landmarks);
+    }
+    if (ctx.croppedFace.empty()) {
+        throw PipelineReject("detection", "No face detected");
+    }
 
-        cv::imwrite("regist_current_face.jpg", cropped_face_image_);
-        cv::imwrite("regist_current_spoof.jpg", spoof_detection_image_);
+    if (ctx.faceArea.empty()) {
+        throw PipelineReject("detection", "No Rect");
+    }
 
-        // --- CEK SPOOF ---
-        float spoofScore;
-        bool isSpoof = depth_->isSpoof(full_image_, faceArea_, spoofScore);
-        if (isSpoof) {
-            throw std::runtime_error("Spoof detected! Score: " + std::to_string(spoofScore));
-        }
-        // -----------------
+    // --- QUALITY GATE --- (mikrodetik, sebelum model mahal)
+    QualityResult quality = qualityGate_.check(ctx.fullImage, ctx.faceArea, ctx.landmarks);
+    if (!quality.ok) {
+        throw PipelineReject(qualityGateName(quality.gate), quality.reason());
+    }
 
-        std::vector<float> emb = embedder_->getNormalizedEmbedding(cropped_face_image_);
-        if (emb.empty()) {
-            throw std::runtime_error("Embedding empty");
-        }
-        db_->add(name, emb);
+    ctx.debug = debugSink().sample();
+    if (ctx.debug) {
+        debugSink().image(std::string(tag) + "_current_face.jpg", ctx.croppedFace);
+        debugSink().image(std::string(tag) + "_current_spoof.jpg", ctx.spoofImage);
+        std::ostringstream area;
+        area << ctx.faceArea;
+        debugSink().text(std::string(tag) + "_face_area.txt", area.str());
+    }
+
+    // Embedding dari cache (retry frame nyaris sama) melewati embedder sepenuhnya;
+    // registrasi tidak memakai cache supaya template galeri selalu dari frame ini.
+    // pipeline_parallel_liveness: embedding masuk antrean bersamaan dengan depth;
+    // bila spoof, job embedding yang belum masuk batch dibuang
+    FaceInput faceInput{ctx.fullImage, ctx.faceArea, ctx.landmarks};
+    const bool useCache = embedCache_.enabled() && !ctx.enrollment;
+    FaceFingerprint cacheKey = useCache ? embedCache_.fingerprint(faceInput) : FaceFingerprint();
+    bool embeddingCached = useCache && embedCache_.lookup(cacheKey, ctx.embedding);
+    std::future<std::vector<float>> pendingEmbedding;
+    InferenceBatcher<FaceInput, std::vector<float>>::CancelToken cancel;
+    if (parallelLiveness_ && !embeddingCached) {
+        cancel = std::make_shared<std::atomic<bool>>(false);
+        pendingEmbedding = embedBatcher_.submit(faceInput, cancel);
+    }
 
-        ResetImages();
+    // --- CEK SPOOF ---
+    DepthCheck check;
+    try {
+        check = depthBatcher_.run(DepthRequest{ctx.fullImage, ctx.faceArea, ctx.debug});
+    } catch (...) {
+        if (cancel) cancel->store(true, std::memory_order_release);
+        throw;
+    }
+    ctx.spoofScore = check.stddev;
+    if (check.spoof) {
+        if (cancel) cancel->store(true, std::memory_order_release);
+        throw PipelineReject("liveness", "Spoof detected! Score: " + std::to_string(ctx.spoofScore));
+    }
+    // -----------------
+
+    if (ctx.debug && !ctx.landmarks.empty()) {
+        cv::Mat frame = ctx.fullImage;
+        std::vector<cv::Point2f> landmarks = ctx.landmarks;
+        debugSink().render(std::string(tag) + "_aligned_face.jpg", [frame, landmarks]() {
+            return alignFace(frame, landmarks, cv::Size(112, 112));
+        });
+    }
+    if (!embeddingCached) {
+        ctx.embedding = pendingEmbedding.valid() ? pendingEmbedding.get() : embedBatcher_.run(faceInput);
+        if (useCache) embedCache_.insert(cacheKey, ctx.embedding);
+    }
+    if (ctx.embedding.empty()) {
+        throw PipelineReject("embedding", "Embedding empty");
+    }
+}
+
+void FaceRecognitionServer::registerFace(const std::string& name, const unsigned char* image, size_t imageSize) {
+    std::cout << "Register face for: " << name << std::endl;
+    try {
+        PipelineContext ctx;
+        ctx.enrollment = true;
+        runPipeline(image, imageSize, ctx, "regist");
+        db_->add(name, ctx.embedding);
     } catch (const std::exception& e) {
         std::cerr << "Register error: " << e.what() << std::endl;
         throw; // rethrow agar ditangkap handleRegister
     }
 }
 
-void FaceRecognitionServer::verifyFace(const std::string& base64Image, std::string& outName, float& outConfidence) {
-    std::cout << "Verify face" << std::endl;
+void FaceRecognitionServer::verifyFace(const unsigned char* image, size_t imageSize, const std::string& claim,
+                                       std::string& outName, float& outConfidence) {
+    std::cout << "Verify face" << (claim.empty() ? "" : " (claim: " + claim + ")") << std::endl;
     outName = "";
     outConfidence = 0.0f;
     
     try {
-        if (!detector_ || !embedder_ || !db_ || !depth_) {
-            throw std::runtime_error("Required components not loaded");
-        }
-        
-        std::vector<unsigned char> decoded = Base64::decode(base64Image);
-        full_image_ = cv::imdecode(decoded, cv::IMREAD_COLOR);
-        if (full_image_.empty()) {
-            throw std::runtime_error("Image empty");
-        }
-
-        detector_->cropFace(full_image_, cropped_face_image_, spoof_detection_image_, faceArea_);
-        if (cropped_face_image_.empty()) {
-            throw std::runtime_error("No face detected");
-        }
-
-        if (faceArea_.empty()) {
-            throw std::runtime_error("No Rect");
-        }
-
-        cv::imwrite("verify_current_face.jpg", cropped_face_image_);
-        cv::imwrite("verify_current_spoof.jpg", spoof_detection_image_);
-
-        // --- CEK SPOOF ---
-        float spoofScore;
-        bool isSpoof = depth_->isSpoof(full_image_, faceArea_, spoofScore);
-        if (isSpoof) {
-            throw std::runtime_error("Spoof detected! Score: " + std::to_string(spoofScore));
-        }
-        // -----------------
-
-        std::vector<float> emb = embedder_->getNormalizedEmbedding(cropped_face_image_);
-        if (emb.empty()) {
-            throw std::runtime_error("Embedding empty");
-        }
-        std::pair<std::string, float> data = db_->find(emb, 0.2f);
-        outName = data.first;
-        outConfidence = data.second;
-
-        ResetImages();
+        PipelineContext ctx;
+        runPipeline(image, imageSize, ctx, "verify");
+        matchFace(ctx.embedding, claim, outName, outConfidence);
     } catch (const std::exception& e) {
         std::cerr << "Verify error: " << e.what() << std::endl;
         throw; // rethrow
     }
 }
 
-void FaceRecognitionServer::ResetImages(){
-    full_image_ = cv::Mat::zeros(cv::Size(640, 480), CV_8UC1);
+std::vector<float> FaceRecognitionServer::embedFace(const FaceInput& face) {
+    FaceFingerprint key = embedCache_.enabled() ? embedCache_.fingerprint(face) : FaceFingerprint();
+    std::vector<float> embedding;
+    if (embedCache_.lookup(key, embedding)) {
+        return embedding;
+    }
+    embedding = embedBatcher_.run(face);
+    embedCache_.insert(key, embedding);
+    return embedding;
+}
+
+void FaceRecognitionServer::matchFace(const std::vector<float>& embedding, const std::string& claim,
+                                      std::string& outName, float& outConfidence) {
+    outName = "";
+    outConfidence = 0.0f;
+    if (!claim.empty()) {
+        // 1:1: O(template per orang), bukan O(galeri)
+        FaceMatch match = db_->verifyClaim(claim, embedding);
+        if (!match.name.empty() && match.score >= matchThreshold_) {
+            outName = match.name;
+            outConfidence = match.score;
+        }
+        return;
+    }
+    std::pair<std::string, float> data = db_->find(embedding, matchThreshold_);
+    outName = data.first;
+    outConfidence = data.second;
 }
 
 void FaceRecognitionServer::start() {
@@ -278,4 +905,8 @@ void FaceRecognitionServer::start() {
 
 void FaceRecognitionServer::stop() {
     listener.close().wait();
+    // db_ kosong bila inisialisasi di constructor gagal
+    if (db_) db_->setScanPool(nullptr);
+    batchPool_.stop();
+    debugSink().stop();
 }
\ No newline at end of file
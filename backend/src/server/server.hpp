@@ -8,10 +8,17 @@
 #include <opencv2/opencv.hpp>
 
 #include "detector/face_detector.hpp"
+#include "detector/face_quality.hpp"
 #include "embedder/face_embedder.hpp"
+#include "embedder/embedding_cache.hpp"
 #include "db/face_db.hpp"
 #include "anti_spoof/anti_spoof.hpp"
 #include "anti_spoof/depth_anything.hpp"
+#include "server/model_pool.hpp"
+#include "inference/inference_batcher.hpp"
+#include "server/pipeline_context.hpp"
+#include "server/stream_session.hpp"
+#include "util/thread_pool.hpp"
 
 class FaceRecognitionServer {
 public:
@@ -30,21 +37,51 @@ private:
 
     void handleRegister(web::http::http_request request);
     void handleVerify(web::http::http_request request);
-    // method dummy
-    void registerFace(const std::string& name, const std::string& base64Image);
-    void verifyFace(const std::string& base64Image, std::string& outName, float& outConfidence);
+    // /v2: body gambar biner atau multipart, tanpa JSON / base64
+    void handleUpload(web::http::http_request request, bool registering);
+    // /batch/register, /batch/verify: banyak gambar per request, hasil per item
+    void handleBatch(web::http::http_request request, bool registering);
+    // image = file gambar ter-encode (JPEG/PNG) hasil decode base64 atau body /v2
+    void registerFace(const std::string& name, const unsigned char* image, size_t imageSize);
+    // claim kosong: 1:N terhadap seluruh galeri; claim terisi: 1:1 hanya template nama itu
+    void verifyFace(const unsigned char* image, size_t imageSize, const std::string& claim,
+                    std::string& outName, float& outConfidence);
+    void handleSearch(web::http::http_request request);
+    // GET /stats: counter cache embedding, batcher, sesi stream
+    void handleStats(web::http::http_request request);
+    // /stream/start, /stream/frame, /stream/end: sesi per kamera, hasil dipakai ulang selama track sama
+    void handleStream(web::http::http_request request, const std::string& action);
+    web::json::value streamFrame(StreamSession& session, const unsigned char* image, size_t imageSize);
+    // 1:N (claim kosong) atau 1:1 terhadap galeri; nama kosong bila di bawah face_threshold
+    void matchFace(const std::vector<float>& embedding, const std::string& claim,
+                   std::string& outName, float& outConfidence);
 
-    void ResetImages();
+    // decode -> deteksi -> quality gate -> cek spoof -> embedding, semua state di ctx.
+    // Penolakan dilempar sebagai PipelineReject dengan nama tahapnya.
+    void runPipeline(const unsigned char* image, size_t imageSize, PipelineContext& ctx, const char* tag);
+    // embedCache_ dulu, baru embedBatcher_ (hasil disimpan ke cache)
+    std::vector<float> embedFace(const FaceInput& face);
 
-    // cache
-    std::unique_ptr<FaceDetector> detector_;
-    std::unique_ptr<FaceEmbedder> embedder_;
+    // Satu instance model per worker; FaceDB sendiri thread-safe
+    ModelPool<FaceDetector> detectors_;
+    ModelPool<FaceEmbedder> embedders_;
+    ModelPool<DepthAntiSpoofing> depths_;
+    // Micro-batching di atas pool: satu worker batcher meminjam satu instance per batch
+    InferenceBatcher<FaceInput, std::vector<float>> embedBatcher_;
+    InferenceBatcher<DepthRequest, DepthCheck> depthBatcher_;
+    // Retry dengan frame nyaris sama memakai embedding sebelumnya (embed_cache_*)
+    EmbeddingCache embedCache_;
+    // Item /batch/* dijalankan paralel di sini; embedding tergabung lewat embedBatcher_.
+    // Juga dipakai FaceDB untuk scan galeri paralel (setScanPool).
+    ThreadPool batchPool_;
+    size_t batchMaxItems_ = 256;
+    float matchThreshold_ = 0.2f;   // face_threshold
+    FaceQualityGate qualityGate_;
+    bool parallelLiveness_ = false; // embedding jalan bersamaan dengan depth, dibatalkan bila spoof
+    size_t searchMaxK_ = 50;
     std::unique_ptr<FaceDB> db_;
+    StreamSessionStore streams_;
     std::unique_ptr<AntiSpoofing> anti_spoof_;
-    std::unique_ptr<DepthAntiSpoofing> depth_;
-
-    cv::Mat full_image_, cropped_face_image_, spoof_detection_image_;
-    cv::Rect faceArea_;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include "server/stream_session.hpp"
+#include "config/load_config.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+StreamOptions StreamOptions::fromConfig(const Config& cfg, float spoofThreshold) {
+    StreamOptions o;
+    o.tracker.minIou = cfg.getFloat("stream_track_iou", o.tracker.minIou);
+    o.tracker.maxMissed = std::max(0, cfg.getInt("stream_max_missed", o.tracker.maxMissed));
+    o.refreshFrames = std::max(0, cfg.getInt("stream_refresh_frames", o.refreshFrames));
+    o.refreshMs = std::max(0, cfg.getInt("stream_refresh_ms", o.refreshMs));
+    o.sessionTtlSec = std::max(1, cfg.getInt("stream_session_ttl_sec", o.sessionTtlSec));
+    o.maxSessions = static_cast<size_t>(std::max(1, cfg.getInt("stream_max_sessions", static_cast<int>(o.maxSessions))));
+    o.temporalLiveness = cfg.getString("liveness_mode", "single") == "temporal";
+    o.liveness = LivenessParams::fromConfig(cfg, spoofThreshold);
+    return o;
+}
+
+bool StreamSession::resultFresh(const StreamOptions& options, StreamClock::time_point now) const {
+    if (!result.valid || result.trackId != tracker.trackId()) return false;
+    if (options.refreshFrames > 0 && result.reused + 1 >= options.refreshFrames) return false;
+    if (options.refreshMs > 0 && now - result.at >= std::chrono::milliseconds(options.refreshMs)) return false;
+    return true;
+}
+
+std::shared_ptr<StreamSession> StreamSessionStore::create(const std::string& claim) {
+    auto now = StreamClock::now();
+    std::lock_guard<std::mutex> lock(mutex_);
+    expireLocked(now);
+    if (sessions_.size() >= options_.maxSessions) return nullptr;
+
+    auto session = std::make_shared<StreamSession>();
+    session->claim = claim;
+    session->tracker = FaceTracker(options_.tracker);
+    session->liveness = TemporalLiveness(options_.liveness);
+    session->lastSeen = now;
+    char id[17];
+    do {
+        std::snprintf(id, sizeof(id), "%016llx", static_cast<unsigned long long>(rng_()));
+    } while (sessions_.count(id));
+    session->id = id;
+    sessions_[session->id] = session;
+    return session;
+}
+
+std::shared_ptr<StreamSession> StreamSessionStore::get(const std::string& id) {
+    auto now = StreamClock::now();
+    std::lock_guard<std::mutex> lock(mutex_);
+    expireLocked(now);
+    auto it = sessions_.find(id);
+    if (it == sessions_.end()) return nullptr;
+    it->second->lastSeen = now;
+    return it->second;
+}
+
+std::shared_ptr<StreamSession> StreamSessionStore::remove(const std::string& id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sessions_.find(id);
+    if (it == sessions_.end()) return nullptr;
+    std::shared_ptr<StreamSession> session = std::move(it->second);
+    sessions_.erase(it);
+    return session;
+}
+
+size_t StreamSessionStore::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sessions_.size();
+}
+
+// Frame yang sedang diproses tetap aman: handler memegang shared_ptr sendiri
+void StreamSessionStore::expireLocked(StreamClock::time_point now) {
+    const auto ttl = std::chrono::seconds(options_.sessionTtlSec);
+    for (auto it = sessions_.begin(); it != sessions_.end();) {
+        if (now - it->second->lastSeen > ttl) {
+            printf("[Stream] Session %s expired\n", it->first.c_str());
+            it = sessions_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef STREAM_SESSION_HPP
+#define STREAM_SESSION_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+#include "anti_spoof/temporal_liveness.hpp"
+#include "detector/face_tracker.hpp"
+
+class Config;
+
+struct StreamOptions {
+    TrackerParams tracker;
+    int refreshFrames = 30;      // analisis ulang setelah N frame dalam track yang sama (0 = tidak)
+    int refreshMs = 2000;        // ... atau setelah N ms (0 = tidak)
+    int sessionTtlSec = 60;      // sesi tanpa frame selama ini dihapus
+    size_t maxSessions = 64;
+    // liveness_mode = temporal: keputusan depth atas beberapa frame (depth tersubsampel,
+    // cue gerak/kedip tiap frame); single: satu frame depth seperti /verify
+    bool temporalLiveness = false;
+    LivenessParams liveness;
+
+    static StreamOptions fromConfig(const Config& cfg, float spoofThreshold);
+};
+
+using StreamClock = std::chrono::steady_clock;
+
+// Hasil tahap mahal (depth + embedding + pencarian galeri) untuk satu track
+struct StreamResult {
+    bool valid = false;
+    bool spoof = false;
+    float spoofScore = 0.0f;
+    std::string name;            // kosong bila tidak ada match
+    float confidence = 0.0f;
+    int trackId = 0;
+    int reused = 0;              // frame yang memakai hasil ini tanpa analisis ulang
+    StreamClock::time_point at;
+};
+
+// State satu kamera / klien stream. Frame satu sesi diproses berurutan (mutex),
+// sesi berbeda berjalan paralel.
+struct StreamSession {
+    std::string id;
+    std::string claim;           // kosong = 1:N, terisi = 1:1 terhadap nama ini
+    std::mutex mutex;
+    FaceTracker tracker;
+    TemporalLiveness liveness;   // jendela frame track aktif (liveness_mode = temporal)
+    StreamResult result;
+    uint64_t frames = 0;
+    uint64_t analyses = 0;
+    StreamClock::time_point lastSeen;  // dijaga mutex StreamSessionStore
+
+    // Hasil boleh dipakai ulang selama track sama dan interval refresh belum lewat
+    bool resultFresh(const StreamOptions& options, StreamClock::time_point now) const;
+};
+
+class StreamSessionStore {
+public:
+    void configure(const StreamOptions& options) { options_ = options; }
+    const StreamOptions& options() const { return options_; }
+
+    // nullptr bila jumlah sesi sudah maxSessions
+    std::shared_ptr<StreamSession> create(const std::string& claim);
+    // nullptr bila id tidak ada / sudah kedaluwarsa; memperbarui lastSeen
+    std::shared_ptr<StreamSession> get(const std::string& id);
+    std::shared_ptr<StreamSession> remove(const std::string& id);
+    size_t size() const;
+
+private:
+    void expireLocked(StreamClock::time_point now);
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<StreamSession>> sessions_;
+    std::mt19937_64 rng_{std::random_device{}()};
+    StreamOptions options_;
+};
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef ALIGNED_ALLOCATOR_HPP
+#define ALIGNED_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// Allocator 64-byte aligned (satu cache line / satu register AVX-512)
+template <typename T, size_t Alignment = 64>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+    AlignedAllocator() noexcept = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    T* allocate(size_t n) {
+        size_t bytes = (n * sizeof(T) + Alignment - 1) / Alignment * Alignment;
+        void* p = std::aligned_alloc(Alignment, bytes);
+        if (!p) throw std::bad_alloc();
+        return static_cast<T*>(p);
+    }
+    void deallocate(T* p, size_t) noexcept { std::free(p); }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept { return false; }
+};
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Thread pool sederhana dengan antrian FIFO. submit() mengembalikan future;
+// exception dari job diteruskan lewat future.get().
+class ThreadPool {
+public:
+    ThreadPool() = default;
+    ~ThreadPool() { stop(); }
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void start(size_t threads) {
+        stop();
+        stopping_ = false;
+        for (size_t i = 0; i < std::max<size_t>(threads, 1); ++i) {
+            threads_.emplace_back(&ThreadPool::workerLoop, this);
+        }
+    }
+
+    // Job yang masih antre tetap dijalankan sebelum thread berhenti
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        for (auto& t : threads_) t.join();
+        threads_.clear();
+    }
+
+    bool running() const { return !threads_.empty(); }
+    size_t size() const { return threads_.size(); }
+
+    template <typename Fn>
+    auto submit(Fn fn) -> std::future<decltype(fn())> {
+        using R = decltype(fn());
+        auto task = std::make_shared<std::packaged_task<R()>>(std::move(fn));
+        std::future<R> result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_ || threads_.empty()) {
+                throw std::runtime_error("ThreadPool: not running");
+            }
+            jobs_.emplace_back([task]() { (*task)(); });
+        }
+        cv_.notify_one();
+        return result;
+    }
+
+private:
+    std::vector<std::thread> threads_;
+    std::deque<std::function<void()>> jobs_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = true;
+
+    void workerLoop() {
+        for (;;) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+                if (jobs_.empty()) return;
+                job = std::move(jobs_.front());
+                jobs_.pop_front();
+            }
+            job();
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,621 @@
+// Benchmark komponen pipeline
+//
+//   bench depth --model depth.onnx --cascade haar.xml --real <dir> --spoof <dir>
+//               [--padding 0.5] [--runs 3]
+//       bandingkan depth_input_mode full vs roi pada frame penuh berlabel:
+//       latency (preprocess + inferensi) dan pemisahan stddev real vs spoof.
+//       Threshold yang disarankan = akurasi tertinggi pada data tersebut.
+//
+//   bench base64 [--image frame.jpg] [--iters 200]
+//       decoder base64 lama (std::string::find per karakter) vs Base64::decode
+//       vs Base64::decodeInto (buffer dipakai ulang), payload JPEG 640x480
+//       (sintetis bila --image tidak diberikan), plus waktu imdecode.
+//
+//   bench detector --model yunet.onnx --cascade haar.xml --images <dir>
+//                  [--labels boxes.txt] [--max-side 320] [--runs 3]
+//       Haar (frame penuh) vs YuNet (frame diperkecil) vs YuNet + fallback Haar
+//       pada gambar yang sama: latency per frame dan recall. Dengan --labels
+//       (baris "<nama file> x y w h", satu wajah per baris) recall = wajah berlabel
+//       yang tertutup deteksi dengan IoU >= 0.5; tanpa label = gambar dengan
+//       minimal satu wajah (anggap tiap gambar berisi wajah).
+//
+//   bench preprocess [--image frame.jpg] [--iters 200] [--depth-size 322]
+//       preprocessing lama vs ImagePreprocessor / warp fused per model
+//       (embedder, embedder + alignment, depth, anti-spoof): latency dan
+//       selisih maksimum tensor input.
+//
+//   bench quality --config config.txt --images <dir>
+//       kalibrasi quality gate: deteksi wajah dengan detector dari config, ukur
+//       semua metrik (ukuran, yaw, roll, brightness, sharpness) pada frame yang
+//       selama ini diterima, tampilkan persentil, berapa frame yang ditolak oleh
+//       threshold quality_* di config, dan threshold yang menerima ~99% frame.
+#include "detector/face_detector.hpp"
+#include "detector/face_quality.hpp"
+#include "config/load_config.hpp"
+#include "anti_spoof/depth_anything.hpp"
+#include "base64/base64.hpp"
+#include "embedder/face_alignment.hpp"
+#include "inference/preprocess.hpp"
+
+#include <opencv2/dnn.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static int usage() {
+    std::cerr << "Usage:\n"
+              << "  bench depth --model depth.onnx --cascade haar.xml --real <dir> --spoof <dir>\n"
+              << "              [--padding 0.5] [--runs 3]\n"
+              << "  bench base64 [--image frame.jpg] [--iters 200]\n"
+              << "  bench detector --model yunet.onnx --cascade haar.xml --images <dir>\n"
+              << "                 [--labels boxes.txt] [--max-side 320] [--runs 3]\n"
+              << "  bench preprocess [--image frame.jpg] [--iters 200] [--depth-size 322]\n"
+              << "  bench quality --config config.txt --images <dir>\n";
+    return 2;
+}
+
+static float flag(std::map<std::string, std::string>& args, const std::string& key, float def) {
+    return args[key].empty() ? def : std::stof(args[key]);
+}
+
+struct Sample {
+    cv::Mat frame;
+    cv::Rect face;
+    bool real;
+};
+
+static size_t loadSamples(const std::string& dir, bool real, FaceDetector& detector, std::vector<Sample>& out) {
+    std::vector<std::string> files;
+    cv::glob(dir + "/*", files, false);
+    size_t skipped = 0;
+    for (const auto& f : files) {
+        cv::Mat img = cv::imread(f, cv::IMREAD_COLOR);
+        if (img.empty()) continue;
+        cv::Rect face = detector.getLargestFace(img) & cv::Rect(0, 0, img.cols, img.rows);
+        if (face.empty()) {
+            ++skipped;
+            continue;
+        }
+        out.push_back(Sample{img, face, real});
+    }
+    return skipped;
+}
+
+struct ModeResult {
+    std::vector<float> real, spoof;
+    double ms = 0.0;
+    size_t runs = 0;
+};
+
+static float mean(const std::vector<float>& v) {
+    return v.empty() ? 0.0f : std::accumulate(v.begin(), v.end(), 0.0f) / v.size();
+}
+
+static float variance(const std::vector<float>& v) {
+    if (v.size() < 2) return 0.0f;
+    float m = mean(v), acc = 0.0f;
+    for (float x : v) acc += (x - m) * (x - m);
+    return acc / (v.size() - 1);
+}
+
+// Threshold dengan akurasi tertinggi (spoof bila stddev < threshold)
+static float bestThreshold(const ModeResult& r, float& accuracyOut) {
+    std::vector<float> candidates(r.real);
+    candidates.insert(candidates.end(), r.spoof.begin(), r.spoof.end());
+    std::sort(candidates.begin(), candidates.end());
+    const size_t total = r.real.size() + r.spoof.size();
+    float best = 0.0f;
+    accuracyOut = 0.0f;
+    for (size_t i = 0; i + 1 < candidates.size(); ++i) {
+        float t = 0.5f * (candidates[i] + candidates[i + 1]);
+        size_t correct = 0;
+        for (float s : r.real) correct += s >= t;
+        for (float s : r.spoof) correct += s < t;
+        float acc = static_cast<float>(correct) / total;
+        if (acc > accuracyOut) {
+            accuracyOut = acc;
+            best = t;
+        }
+    }
+    return best;
+}
+
+static void printMode(const char* name, const ModeResult& r) {
+    float accuracy = 0.0f;
+    float threshold = bestThreshold(r, accuracy);
+    float spread = std::sqrt(variance(r.real) + variance(r.spoof));
+    float separation = spread > 0.0f ? (mean(r.real) - mean(r.spoof)) / spread : 0.0f;
+    std::cout << std::fixed << std::setprecision(4)
+              << "[" << name << "]\n"
+              << "  stddev real: mean " << mean(r.real) << ", min "
+              << (r.real.empty() ? 0.0f : *std::min_element(r.real.begin(), r.real.end())) << "\n"
+              << "  stddev spoof: mean " << mean(r.spoof) << ", max "
+              << (r.spoof.empty() ? 0.0f : *std::max_element(r.spoof.begin(), r.spoof.end())) << "\n"
+              << "  separation (d'): " << separation << "\n"
+              << "  suggested threshold: " << threshold << " (accuracy " << accuracy << ")\n"
+              << std::setprecision(2)
+              << "  latency: " << (r.runs ? r.ms / r.runs : 0.0) << " ms/frame" << std::endl;
+}
+
+static int cmdDepth(std::map<std::string, std::string>& args) {
+    if (args["model"].empty() || args["cascade"].empty() || args["real"].empty() || args["spoof"].empty()) {
+        return usage();
+    }
+    FaceDetector detector;
+    if (!detector.loadCascade(args["cascade"])) return 1;
+    DepthAntiSpoofing depth;
+    if (!depth.LoadModel(args["model"])) return 1;
+
+    std::vector<Sample> samples;
+    size_t skipped = loadSamples(args["real"], true, detector, samples);
+    skipped += loadSamples(args["spoof"], false, detector, samples);
+    if (samples.empty()) {
+        std::cerr << "No frames with a detected face" << std::endl;
+        return 1;
+    }
+    std::cout << "frames: " << samples.size() << " (no face: " << skipped << ")" << std::endl;
+
+    const int runs = std::max(1, static_cast<int>(flag(args, "runs", 3)));
+    const float padding = flag(args, "padding", 0.5f);
+    const std::pair<const char*, DepthInputMode> modes[] = {
+        {"full", DepthInputMode::Full}, {"roi", DepthInputMode::Roi}};
+
+    for (const auto& mode : modes) {
+        depth.setInputMode(mode.second, padding);
+        depth.faceDepthStddev(samples[0].frame, samples[0].face);  // warm-up
+
+        ModeResult result;
+        for (const auto& s : samples) {
+            float stddev = 0.0f;
+            for (int i = 0; i < runs; ++i) {
+                auto t0 = Clock::now();
+                stddev = depth.faceDepthStddev(s.frame, s.face);
+                result.ms += std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+                ++result.runs;
+            }
+            (s.real ? result.real : result.spoof).push_back(stddev);
+        }
+        printMode(mode.first, result);
+    }
+    return 0;
+}
+
+// Implementasi sebelum decoder table/SIMD, sebagai baseline
+static std::vector<unsigned char> legacyDecode(const std::string& encoded) {
+    static const std::string chars =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::vector<unsigned char> ret;
+    unsigned char quad[4];
+    int n = 0;
+    for (char c : encoded) {
+        if (c == '=' || (!isalnum(static_cast<unsigned char>(c)) && c != '+' && c != '/')) break;
+        quad[n++] = static_cast<unsigned char>(chars.find(c));
+        if (n == 4) {
+            ret.push_back((quad[0] << 2) + ((quad[1] & 0x30) >> 4));
+            ret.push_back(((quad[1] & 0xf) << 4) + ((quad[2] & 0x3c) >> 2));
+            ret.push_back(((quad[2] & 0x3) << 6) + quad[3]);
+            n = 0;
+        }
+    }
+    for (int j = n; j < 4; ++j) quad[j] = 0;
+    unsigned char tail[3] = {
+        static_cast<unsigned char>((quad[0] << 2) + ((quad[1] & 0x30) >> 4)),
+        static_cast<unsigned char>(((quad[1] & 0xf) << 4) + ((quad[2] & 0x3c) >> 2)),
+        static_cast<unsigned char>(((quad[2] & 0x3) << 6) + quad[3])};
+    for (int j = 0; j + 1 < n; ++j) ret.push_back(tail[j]);
+    return ret;
+}
+
+static std::string encodeBase64(const std::vector<unsigned char>& data) {
+    static const char* chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve((data.size() + 2) / 3 * 4);
+    size_t i = 0;
+    for (; i + 3 <= data.size(); i += 3) {
+        unsigned v = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+        out += chars[v >> 18];
+        out += chars[(v >> 12) & 63];
+        out += chars[(v >> 6) & 63];
+        out += chars[v & 63];
+    }
+    if (i < data.size()) {
+        unsigned v = data[i] << 16;
+        if (i + 1 < data.size()) v |= data[i + 1] << 8;
+        out += chars[v >> 18];
+        out += chars[(v >> 12) & 63];
+        out += i + 1 < data.size() ? chars[(v >> 6) & 63] : '=';
+        out += '=';
+    }
+    return out;
+}
+
+// Hasil tiap iterasi ditulis ke sini supaya tidak dihapus optimizer
+static volatile size_t g_sink = 0;
+
+template <typename Fn>
+static double timeMs(int iters, Fn fn) {
+    auto t0 = Clock::now();
+    for (int i = 0; i < iters; ++i) fn();
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count() / iters;
+}
+
+// --image atau frame sintetis 640x480; kosong bila file tidak bisa dibaca
+static cv::Mat benchFrame(std::map<std::string, std::string>& args) {
+    cv::Mat frame;
+    if (!args["image"].empty()) {
+        frame = cv::imread(args["image"], cv::IMREAD_COLOR);
+        if (frame.empty()) std::cerr << "Cannot read " << args["image"] << std::endl;
+    } else {
+        // Noise yang di-blur: ukuran JPEG mendekati foto webcam 640x480
+        frame = cv::Mat(480, 640, CV_8UC3);
+        cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+        cv::GaussianBlur(frame, frame, cv::Size(5, 5), 0);
+    }
+    return frame;
+}
+
+static int cmdBase64(std::map<std::string, std::string>& args) {
+    cv::Mat frame = benchFrame(args);
+    if (frame.empty()) return 1;
+    std::vector<unsigned char> jpeg;
+    cv::imencode(".jpg", frame, jpeg, {cv::IMWRITE_JPEG_QUALITY, 90});
+    const std::string payload = "data:image/jpeg;base64," + encodeBase64(jpeg);
+    const std::string raw = payload.substr(payload.find(',') + 1);
+    const int iters = std::max(1, static_cast<int>(flag(args, "iters", 200)));
+
+    std::vector<unsigned char> buffer;
+    if (legacyDecode(raw) != jpeg || !Base64::decodeInto(payload, buffer) || buffer != jpeg) {
+        std::cerr << "Decoder output mismatch" << std::endl;
+        return 1;
+    }
+
+    double legacy = timeMs(iters, [&] { g_sink = legacyDecode(raw).size(); });
+    double decode = timeMs(iters, [&] { g_sink = Base64::decode(payload).size(); });
+    double into = timeMs(iters, [&] { Base64::decodeInto(payload, buffer); g_sink = buffer.size(); });
+    double imdecode = timeMs(std::max(1, iters / 10), [&] { g_sink = cv::imdecode(buffer, cv::IMREAD_COLOR).total(); });
+
+    const double mb = raw.size() / (1024.0 * 1024.0);
+    std::cout << std::fixed << std::setprecision(3)
+              << "payload: " << raw.size() << " chars base64, " << jpeg.size() << " bytes jpeg ("
+              << frame.cols << "x" << frame.rows << "), decoder " << Base64::implementation() << "\n"
+              << "  legacy            " << legacy << " ms  (" << mb / (legacy / 1000.0) << " MB/s)\n"
+              << "  Base64::decode    " << decode << " ms  (" << mb / (decode / 1000.0) << " MB/s)\n"
+              << "  decodeInto reuse  " << into << " ms  (" << mb / (into / 1000.0) << " MB/s)\n"
+              << "  cv::imdecode      " << imdecode << " ms\n"
+              << "  speedup vs legacy " << std::setprecision(1) << legacy / into << "x" << std::endl;
+    return 0;
+}
+
+// Implementasi preprocessing sebelum ImagePreprocessor, sebagai baseline
+static cv::Mat legacyEmbedderBlob(const cv::Mat& face) {
+    cv::Mat resized;
+    cv::resize(face, resized, cv::Size(112, 112));
+    cv::Mat blob = cv::dnn::blobFromImage(resized, 1.0, cv::Size(112, 112), cv::Scalar(127.5, 127.5, 127.5), true, false);
+    blob /= 127.5;
+    blob -= 1.0;
+    return blob;
+}
+
+static std::vector<float> legacyDepthBlob(const cv::Mat& frame, cv::Size size, const float mean[3], const float std[3]) {
+    std::vector<float> blob(3 * size.area());
+    cv::Mat resized, rgb;
+    cv::resize(frame, resized, size, 0, 0, cv::INTER_CUBIC);
+    cv::cvtColor(resized, rgb, cv::COLOR_BGR2RGB);
+    const int plane = size.area();
+    for (int y = 0; y < size.height; ++y) {
+        for (int x = 0; x < size.width; ++x) {
+            cv::Vec3b pixel = rgb.at<cv::Vec3b>(y, x);
+            int idx = y * size.width + x;
+            for (int c = 0; c < 3; ++c) blob[c * plane + idx] = (pixel[c] / 255.0f - mean[c]) / std[c];
+        }
+    }
+    return blob;
+}
+
+static cv::Mat legacySpoofBlob(const cv::Mat& face) {
+    cv::Mat resized, rgb, floatImg;
+    cv::resize(face, resized, cv::Size(224, 224));
+    cv::cvtColor(resized, rgb, cv::COLOR_BGR2RGB);
+    rgb.convertTo(floatImg, CV_32FC3, 1.0 / 255.0);
+    return cv::dnn::blobFromImage(floatImg, 1.0, cv::Size(224, 224), cv::Scalar(0, 0, 0), false, false);
+}
+
+static float maxAbsDiff(const float* a, const float* b, size_t n) {
+    float m = 0.0f;
+    for (size_t i = 0; i < n; ++i) m = std::max(m, std::fabs(a[i] - b[i]));
+    return m;
+}
+
+static void printPreprocess(const char* name, double legacy, double fused, float diff) {
+    std::cout << std::fixed << std::setprecision(3)
+              << "[" << name << "]\n"
+              << "  legacy " << legacy << " ms, fused " << fused << " ms (" << std::setprecision(1)
+              << legacy / fused << "x), max |diff| " << std::setprecision(4) << diff << std::endl;
+}
+
+static int cmdPreprocess(std::map<std::string, std::string>& args) {
+    cv::Mat frame = benchFrame(args);
+    if (frame.empty()) return 1;
+    const int iters = std::max(1, static_cast<int>(flag(args, "iters", 200)));
+    const int depthSide = static_cast<int>(flag(args, "depth-size", 322));
+    // Crop wajah tipikal: ~1/3 tinggi frame di tengah
+    const int side = frame.rows / 3;
+    const cv::Mat face = frame(cv::Rect((frame.cols - side) / 2, (frame.rows - side) / 2, side, side));
+    std::cout << "frame " << frame.cols << "x" << frame.rows << ", face crop " << side << "x" << side
+              << ", " << iters << " iterations, linear kernel " << ImagePreprocessor::activeIsa() << std::endl;
+
+    TensorBuffer buffer;
+    {
+        ImagePreprocessor pre(cv::Size(112, 112), NormalizeParams::affine(1.0f / 127.5f, -2.0f));
+        float* out = buffer.reserve(pre.tensorSize());
+        cv::Mat ref = legacyEmbedderBlob(face);
+        pre.run(face, out);
+        float diff = maxAbsDiff(ref.ptr<float>(), out, pre.tensorSize());
+        double legacy = timeMs(iters, [&] { g_sink = legacyEmbedderBlob(face).total(); });
+        double fused = timeMs(iters, [&] { pre.run(face, out); g_sink = static_cast<size_t>(out[0]); });
+        printPreprocess("embedder 112x112 (linear)", legacy, fused, diff);
+
+        // Alignment: warpAffine + pipeline lama vs warp+normalisasi satu pass
+        const auto& tmpl = arcfaceTemplate();
+        std::vector<cv::Point2f> landmarks;
+        for (const auto& p : tmpl) landmarks.emplace_back(face.cols * 0.5f + (p.x - 56.0f) * side / 112.0f + (frame.cols - side) / 2,
+                                                          face.rows * 0.5f + (p.y - 56.0f) * side / 112.0f + (frame.rows - side) / 2);
+        cv::Mat transform = similarityTransform(landmarks, cv::Size(112, 112));
+        auto legacyAligned = [&] { return legacyEmbedderBlob(alignFace(frame, landmarks, cv::Size(112, 112))); };
+        cv::Mat refAligned = legacyAligned();
+        warpNormalizeInto(frame, transform, cv::Size(112, 112), pre.normalize(), out);
+        diff = maxAbsDiff(refAligned.ptr<float>(), out, pre.tensorSize());
+        legacy = timeMs(iters, [&] { g_sink = legacyAligned().total(); });
+        fused = timeMs(iters, [&] {
+            warpNormalizeInto(frame, similarityTransform(landmarks, cv::Size(112, 112)), cv::Size(112, 112),
+                              pre.normalize(), out);
+            g_sink = static_cast<size_t>(out[0]);
+        });
+        printPreprocess("embedder aligned 112x112", legacy, fused, diff);
+    }
+    {
+        const float mean[3] = {0.485f, 0.456f, 0.406f}, std[3] = {0.229f, 0.224f, 0.225f};
+        const cv::Size size(depthSide, depthSide);
+        ImagePreprocessor pre(size, NormalizeParams::meanStd(mean, std), cv::INTER_CUBIC);
+        float* out = buffer.reserve(pre.tensorSize());
+        std::vector<float> ref = legacyDepthBlob(frame, size, mean, std);
+        pre.run(frame, out);
+        float diff = maxAbsDiff(ref.data(), out, pre.tensorSize());
+        double legacy = timeMs(iters, [&] { g_sink = legacyDepthBlob(frame, size, mean, std).size(); });
+        double fused = timeMs(iters, [&] { pre.run(frame, out); g_sink = static_cast<size_t>(out[0]); });
+        printPreprocess(("depth " + std::to_string(depthSide) + "x" + std::to_string(depthSide) + " (cubic)").c_str(),
+                        legacy, fused, diff);
+    }
+    {
+        ImagePreprocessor pre(cv::Size(224, 224), NormalizeParams::affine(1.0f / 255.0f, 0.0f));
+        float* out = buffer.reserve(pre.tensorSize());
+        cv::Mat ref = legacySpoofBlob(face);
+        pre.run(face, out);
+        float diff = maxAbsDiff(ref.ptr<float>(), out, pre.tensorSize());
+        double legacy = timeMs(iters, [&] { g_sink = legacySpoofBlob(face).total(); });
+        double fused = timeMs(iters, [&] { pre.run(face, out); g_sink = static_cast<size_t>(out[0]); });
+        printPreprocess("anti-spoof 224x224 (linear)", legacy, fused, diff);
+    }
+    return 0;
+}
+
+static float iou(const cv::Rect& a, const cv::Rect& b) {
+    float inter = static_cast<float>((a & b).area());
+    float uni = static_cast<float>(a.area() + b.area()) - inter;
+    return uni > 0.0f ? inter / uni : 0.0f;
+}
+
+struct LabeledImage {
+    std::string file;
+    cv::Mat image;
+    std::vector<cv::Rect> faces;  // kosong tanpa --labels
+};
+
+static int cmdDetector(std::map<std::string, std::string>& args) {
+    if (args["model"].empty() || args["cascade"].empty() || args["images"].empty()) {
+        return usage();
+    }
+    std::map<std::string, std::vector<cv::Rect>> labels;
+    if (!args["labels"].empty()) {
+        std::ifstream in(args["labels"]);
+        if (!in) {
+            std::cerr << "Cannot read " << args["labels"] << std::endl;
+            return 1;
+        }
+        std::string file;
+        cv::Rect r;
+        while (in >> file >> r.x >> r.y >> r.width >> r.height) labels[file].push_back(r);
+    }
+
+    std::vector<std::string> files;
+    cv::glob(args["images"] + "/*", files, false);
+    std::sort(files.begin(), files.end());
+    std::vector<LabeledImage> images;
+    size_t labeledFaces = 0;
+    for (const auto& f : files) {
+        LabeledImage li;
+        li.file = f.substr(f.find_last_of('/') + 1);
+        if (!labels.empty()) {
+            auto it = labels.find(li.file);
+            if (it == labels.end()) continue;
+            li.faces = it->second;
+            labeledFaces += li.faces.size();
+        }
+        li.image = cv::imread(f, cv::IMREAD_COLOR);
+        if (!li.image.empty()) images.push_back(std::move(li));
+    }
+    if (images.empty()) {
+        std::cerr << "No images in " << args["images"] << std::endl;
+        return 1;
+    }
+
+    DetectorOptions options;
+    options.backend = "yunet";
+    options.modelPath = args["model"];
+    options.cascadePath = args["cascade"];
+    options.yunet.maxSide = static_cast<int>(flag(args, "max-side", static_cast<float>(options.yunet.maxSide)));
+    FaceDetector haar, yunet, combined;
+    if (!haar.loadCascade(options.cascadePath)) return 1;
+    options.haarFallback = false;
+    if (!yunet.load(options) || std::string(yunet.backendName()) != "yunet") return 1;
+    options.haarFallback = true;
+    if (!combined.load(options)) return 1;
+
+    const int runs = std::max(1, static_cast<int>(flag(args, "runs", 3)));
+    std::cout << "images: " << images.size();
+    if (!labels.empty()) std::cout << ", labeled faces: " << labeledFaces;
+    std::cout << ", yunet max side " << options.yunet.maxSide << std::endl;
+
+    const std::pair<const char*, FaceDetector*> detectors[] = {
+        {"haar", &haar}, {"yunet", &yunet}, {"yunet+haar", &combined}};
+    for (const auto& d : detectors) {
+        d.second->detect(images[0].image);  // warm-up
+        std::vector<float> ms;
+        size_t found = 0, withFace = 0, detections = 0;
+        for (const auto& li : images) {
+            std::vector<FaceDetection> faces;
+            for (int i = 0; i < runs; ++i) {
+                auto t0 = Clock::now();
+                faces = d.second->detect(li.image);
+                ms.push_back(std::chrono::duration<double, std::milli>(Clock::now() - t0).count());
+            }
+            detections += faces.size();
+            withFace += !faces.empty();
+            for (const auto& truth : li.faces) {
+                for (const auto& f : faces) {
+                    if (iou(truth, f.box) >= 0.5f) {
+                        ++found;
+                        break;
+                    }
+                }
+            }
+        }
+        std::sort(ms.begin(), ms.end());
+        float recall = labels.empty() ? static_cast<float>(withFace) / images.size()
+                                      : static_cast<float>(found) / std::max<size_t>(labeledFaces, 1);
+        std::cout << std::fixed << std::setprecision(3)
+                  << "[" << d.first << "]\n"
+                  << "  recall" << (labels.empty() ? " (images with a face)" : " @IoU0.5") << ": " << recall << "\n"
+                  << "  detections: " << detections << "\n"
+                  << std::setprecision(2)
+                  << "  latency: mean " << mean(ms) << " ms, p95 "
+                  << ms[static_cast<size_t>(0.95 * (ms.size() - 1))] << " ms" << std::endl;
+    }
+    return 0;
+}
+
+static float percentile(std::vector<float> v, float p) {
+    if (v.empty()) return 0.0f;
+    std::sort(v.begin(), v.end());
+    return v[static_cast<size_t>(p * (v.size() - 1) + 0.5f)];
+}
+
+static int cmdQuality(std::map<std::string, std::string>& args) {
+    if (args["config"].empty() || args["images"].empty()) return usage();
+    Config cfg(args["config"]);
+    FaceDetector detector;
+    if (!detector.load(DetectorOptions::fromConfig(cfg))) {
+        std::cerr << "Cannot load face detector from " << args["config"] << std::endl;
+        return 1;
+    }
+    QualityParams params = QualityParams::fromConfig(cfg);
+    // Threshold config dinilai per gate, terlepas dari quality_gates yang aktif
+    params.gates = {QualityGate::FaceSize, QualityGate::Pose, QualityGate::Exposure, QualityGate::Blur};
+
+    std::vector<std::string> files;
+    cv::glob(args["images"] + "/*", files, false);
+    std::vector<float> size, yaw, roll, brightness, sharpness;
+    size_t noFace = 0;
+    std::map<std::string, size_t> rejected;
+    for (const auto& f : files) {
+        cv::Mat img = cv::imread(f, cv::IMREAD_COLOR);
+        if (img.empty()) continue;
+        // Wajah terbesar, sama seperti FaceDetector::cropFace di server
+        FaceDetection face = detector.getLargestDetection(img);
+        face.box &= cv::Rect(0, 0, img.cols, img.rows);
+        if (face.box.empty()) {
+            ++noFace;
+            continue;
+        }
+        QualityMetrics m = FaceQualityGate::measure(img, face.box, face.landmarks);
+        size.push_back(m.faceSize);
+        if (m.yaw >= 0.0f) {
+            yaw.push_back(m.yaw);
+            roll.push_back(m.rollDeg);
+        }
+        brightness.push_back(m.brightness);
+        sharpness.push_back(m.sharpness);
+        for (QualityGate gate : params.gates) {
+            QualityParams single = params;
+            single.gates = {gate};
+            if (!FaceQualityGate(single).check(img, face.box, face.landmarks).ok) ++rejected[qualityGateName(gate)];
+        }
+    }
+    if (size.empty()) {
+        std::cerr << "No faces found in " << args["images"] << std::endl;
+        return 1;
+    }
+
+    std::cout << "frames with a face: " << size.size() << ", without: " << noFace
+              << ", with landmarks: " << yaw.size() << "\n"
+              << std::fixed << std::setprecision(2)
+              << "metric        p1       p5      p50      p95      p99\n";
+    const std::pair<const char*, const std::vector<float>*> metrics[] = {
+        {"size", &size}, {"yaw", &yaw}, {"roll", &roll}, {"brightness", &brightness}, {"sharpness", &sharpness}};
+    for (const auto& m : metrics) {
+        if (m.second->empty()) continue;
+        std::cout << std::left << std::setw(11) << m.first << std::right;
+        for (float p : {0.01f, 0.05f, 0.5f, 0.95f, 0.99f}) std::cout << std::setw(9) << percentile(*m.second, p);
+        std::cout << "\n";
+    }
+    std::cout << "rejected by current quality_* thresholds:\n";
+    for (QualityGate gate : params.gates) {
+        size_t n = rejected[qualityGateName(gate)];
+        std::cout << "  " << qualityGateName(gate) << ": " << n << " (" << 100.0 * n / size.size() << "%)\n";
+    }
+    // Batas yang masih menerima ~99% frame yang selama ini diterima
+    std::cout << "suggested (accepts ~99% of these frames):\n"
+              << "  quality_min_face = " << std::floor(percentile(size, 0.01f)) << "\n";
+    if (!yaw.empty()) {
+        std::cout << "  quality_max_yaw = " << percentile(yaw, 0.99f) << "\n"
+                  << "  quality_max_roll = " << std::ceil(percentile(roll, 0.99f)) << "\n";
+    }
+    std::cout << "  quality_min_brightness = " << std::floor(percentile(brightness, 0.005f)) << "\n"
+              << "  quality_max_brightness = " << std::ceil(percentile(brightness, 0.995f)) << "\n"
+              << "  quality_min_sharpness = " << percentile(sharpness, 0.01f) << std::endl;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) return usage();
+    std::string cmd = argv[1];
+    std::map<std::string, std::string> args;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        std::string key = argv[i];
+        if (key.rfind("--", 0) != 0) return usage();
+        args[key.substr(2)] = argv[i + 1];
+    }
+
+    try {
+        if (cmd == "depth") return cmdDepth(args);
+        if (cmd == "base64") return cmdBase64(args);
+        if (cmd == "detector") return cmdDetector(args);
+        if (cmd == "preprocess") return cmdPreprocess(args);
+        if (cmd == "quality") return cmdQuality(args);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return usage();
+}
@@ -0,0 +1,62 @@
+#!/usr/bin/env python3
+"""Ubah model ONNX static (batch 1) menjadi batch dinamis.
+
+    python3 export_dynamic_batch.py depth_anything_v2_vits_322_static.onnx depth_dynamic.onnx
+    python3 export_dynamic_batch.py arcfaceresnet100-8.onnx arcface_dynamic.onnx
+
+Dimensi 0 semua input dan output diganti menjadi simbol "batch", lalu
+hasilnya diverifikasi dengan onnxruntime: Run batch 2 harus sama dengan
+dua Run batch 1. Bila graph menyimpan batch 1 di Reshape konstan, verifikasi
+gagal dan model perlu di-export ulang dari framework asalnya dengan dynamic_axes.
+DepthAntiSpoofing dan FaceEmbedder mendeteksi batch dinamis otomatis dari
+shape input; model batch 1 dijalankan satu wajah per Run.
+"""
+import sys
+
+import numpy as np
+import onnx
+import onnxruntime as ort
+
+
+def make_dynamic(model):
+    for value in list(model.graph.input) + list(model.graph.output):
+        dims = value.type.tensor_type.shape.dim
+        if dims:
+            dims[0].ClearField("dim_value")
+            dims[0].dim_param = "batch"
+    # Shape hasil inferensi lama masih menyimpan batch 1
+    del model.graph.value_info[:]
+    return model
+
+
+def verify(path):
+    sess = ort.InferenceSession(path, providers=["CPUExecutionProvider"])
+    inp = sess.get_inputs()[0]
+    _, c, h, w = inp.shape
+    rng = np.random.default_rng(0)
+    batch = rng.standard_normal((2, c, h, w)).astype(np.float32)
+    together = sess.run(None, {inp.name: batch})[0]
+    single = np.concatenate([sess.run(None, {inp.name: batch[i:i + 1]})[0] for i in range(2)])
+    err = float(np.max(np.abs(together - single)))
+    print(f"batch 2 vs 2x batch 1: max abs diff {err:.3e}")
+    return err < 1e-3
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__)
+        return 2
+    model = make_dynamic(onnx.load(sys.argv[1]))
+    onnx.checker.check_model(model)
+    onnx.save(model, sys.argv[2])
+    try:
+        ok = verify(sys.argv[2])
+    except Exception as e:  # noqa: BLE001
+        print(f"verification failed: {e}")
+        ok = False
+    print("OK" if ok else "FAILED: re-export the model with dynamic_axes={<input>: {0: 'batch'}}")
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,120 @@
+// Utilitas offline untuk file face_db.bin
+//
+//   face_db_tool convert <legacy.bin> <out.bin>   konversi format lama ke v2
+//   face_db_tool info <face_db.bin>               ringkasan isi file
+//   face_db_tool compact <in.bin> <out.bin> [--merge-threshold 0.95] [--max-templates N]
+//       merge template redundan per identitas (cosine >= threshold jadi satu
+//       rata-rata ter-normalisasi). Jalankan saat server mati / setelah checkpoint.
+#include "db/face_store.hpp"
+#include "db/identity_centroids.hpp"
+#include <iostream>
+#include <map>
+#include <string>
+
+#include <sys/stat.h>
+
+static int usage() {
+    std::cerr << "Usage:\n"
+              << "  face_db_tool convert <legacy.bin> <out.bin>\n"
+              << "  face_db_tool info <face_db.bin>\n"
+              << "  face_db_tool compact <in.bin> <out.bin> [--merge-threshold 0.95] [--max-templates N]\n";
+    return 2;
+}
+
+static int cmdConvert(const std::string& in, const std::string& out) {
+    if (FaceStore::probe(in) != FaceStore::FileKind::Legacy) {
+        std::cerr << "Not a legacy face_db file: " << in << std::endl;
+        return 1;
+    }
+    size_t count = 0;
+    if (!FaceStore::convertLegacy(in, out, &count)) {
+        std::cerr << "Conversion failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Converted " << count << " records -> " << out << std::endl;
+    return 0;
+}
+
+static int cmdInfo(const std::string& path) {
+    FaceStore store;
+    if (!store.open(path)) {
+        std::cerr << "Cannot open " << path << " (legacy files must be converted first)" << std::endl;
+        return 1;
+    }
+    std::vector<FaceRecord> records;
+    if (!store.readRecords(records)) {
+        std::cerr << "Corrupt string table" << std::endl;
+        return 1;
+    }
+    std::map<std::string, size_t> perName;
+    for (const auto& rec : records) perName[rec.name]++;
+
+    std::cout << "format v" << FaceStore::kVersion << "\n"
+              << "records:    " << store.count() << " / capacity " << store.capacity() << "\n"
+              << "dim:        " << store.dim() << " (stride " << store.stride() << ")\n"
+              << "identities: " << perName.size() << std::endl;
+
+    struct stat st;
+    if (::stat((path + ".wal").c_str(), &st) == 0) {
+        std::cout << "wal:        " << st.st_size << " bytes pending checkpoint" << std::endl;
+    }
+    return 0;
+}
+
+static int cmdCompact(const std::string& in, const std::string& out, const CompactionParams& params) {
+    if (in == out) {
+        std::cerr << "Output must differ from input" << std::endl;
+        return 1;
+    }
+    FaceStore store;
+    if (!store.open(in)) {
+        std::cerr << "Cannot open " << in << " (legacy files must be converted first)" << std::endl;
+        return 1;
+    }
+    struct stat st;
+    if (::stat((in + ".wal").c_str(), &st) == 0 && st.st_size > 0) {
+        std::cerr << "Warning: " << in << ".wal has " << st.st_size
+                  << " bytes not yet checkpointed, those records are not compacted" << std::endl;
+    }
+    std::vector<FaceRecord> records;
+    if (!store.readRecords(records)) {
+        std::cerr << "Corrupt string table" << std::endl;
+        return 1;
+    }
+    EmbeddingMatrix templates;
+    templates.attach(store.embeddingData(), store.dim(), store.stride(), records.size());
+
+    std::vector<FaceRecord> outRecords;
+    EmbeddingMatrix outTemplates;
+    CompactionReport report = compactTemplates(records, templates, params, outRecords, outTemplates);
+    if (!FaceStore::writeSnapshot(out, outRecords, outTemplates)) {
+        std::cerr << "Failed to write " << out << std::endl;
+        return 1;
+    }
+    std::cout << "identities: " << report.identities << "\n"
+              << "templates:  " << report.templatesIn << " -> " << report.templatesOut << "\n"
+              << "written:    " << out << std::endl;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) return usage();
+    std::string cmd = argv[1];
+    if (cmd == "convert" && argc == 4) return cmdConvert(argv[2], argv[3]);
+    if (cmd == "info" && argc == 3) return cmdInfo(argv[2]);
+    if (cmd == "compact" && argc >= 4 && argc % 2 == 0) {
+        CompactionParams params;
+        try {
+            for (int i = 4; i + 1 < argc; i += 2) {
+                std::string key = argv[i];
+                if (key == "--merge-threshold") params.mergeThreshold = std::stof(argv[i + 1]);
+                else if (key == "--max-templates") params.maxTemplates = std::stoul(argv[i + 1]);
+                else return usage();
+            }
+        } catch (const std::exception&) {
+            return usage();
+        }
+        return cmdCompact(argv[2], argv[3], params);
+    }
+    return usage();
+}
@@ -0,0 +1,334 @@
+// Kalibrasi dan accuracy gate untuk model INT8
+//
+//   model_quant_tool dump   --config config.txt --frames <dir> --out <dir> [--boxes boxes.txt]
+//                           [--embedder m.onnx] [--depth m.onnx]
+//       simpan tensor input hasil preprocess C++ (sama persis dengan server)
+//       sebagai data kalibrasi untuk tools/quantize_models.py
+//
+//   model_quant_tool report --config config.txt --frames <dir> [--boxes boxes.txt]
+//                           [--embedder fp32.onnx --embedder-int8 int8.onnx]
+//                           [--depth fp32.onnx --depth-int8 int8.onnx] [gate options]
+//       bandingkan INT8 terhadap fp32: cosine embedding dan drift stddev depth.
+//       Exit code 0 = PASS, 1 = FAIL.
+//
+// Gate options (default): --min-cosine 0.99 (rata-rata), --min-cosine-worst 0.95,
+//   --max-stddev-drift 0.10 (relatif, rata-rata), --max-flip-rate 0.01,
+//   --spoof-threshold (default spoof_threshold / spoof_threshold_roi dari config)
+//
+// Folder --frames berisi frame penuh seperti yang dikirim client (mis. regist_full.jpg).
+// Wajah dicari dengan detector dari config (wajah terbesar, seperti server), atau
+// dibaca dari --boxes: satu baris "<nama file> x y w h" per frame. Input depth dibangun
+// lewat depth_input_mode / depth_roi_padding, input embedder mengikuti face_alignment.
+#include "embedder/face_embedder.hpp"
+#include "anti_spoof/depth_anything.hpp"
+#include "detector/face_detector.hpp"
+#include "config/load_config.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+
+using Clock = std::chrono::steady_clock;
+
+static int usage() {
+    std::cerr << "Usage:\n"
+              << "  model_quant_tool dump --config config.txt --frames <dir> --out <dir> [--boxes boxes.txt]\n"
+              << "                        [--embedder m.onnx] [--depth m.onnx]\n"
+              << "  model_quant_tool report --config config.txt --frames <dir> [--boxes boxes.txt]\n"
+              << "                          [--embedder fp32.onnx --embedder-int8 int8.onnx]\n"
+              << "                          [--depth fp32.onnx --depth-int8 int8.onnx]\n"
+              << "                          [--min-cosine 0.99] [--min-cosine-worst 0.95]\n"
+              << "                          [--max-stddev-drift 0.10] [--max-flip-rate 0.01] [--spoof-threshold t]\n";
+    return 2;
+}
+
+// Frame penuh + wajah di dalamnya, sama dengan yang diterima embedder / depth di server
+struct Sample {
+    std::string name;
+    cv::Mat frame;
+    FaceDetection face;
+};
+
+static std::map<std::string, cv::Rect> loadBoxes(const std::string& path) {
+    std::map<std::string, cv::Rect> boxes;
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("cannot open " + path);
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream ss(line);
+        std::string name;
+        cv::Rect box;
+        if (ss >> name >> box.x >> box.y >> box.width >> box.height) boxes[name] = box;
+    }
+    return boxes;
+}
+
+static std::vector<Sample> loadSamples(const Config& cfg, std::map<std::string, std::string>& args) {
+    std::map<std::string, cv::Rect> boxes;
+    FaceDetector detector;
+    if (!args["boxes"].empty()) {
+        boxes = loadBoxes(args["boxes"]);
+    } else if (!detector.load(DetectorOptions::fromConfig(cfg))) {
+        throw std::runtime_error("cannot load face detector from " + args["config"]);
+    }
+
+    std::vector<std::string> files;
+    cv::glob(args["frames"] + "/*", files, false);
+    std::sort(files.begin(), files.end());
+    std::vector<Sample> samples;
+    size_t noFace = 0;
+    for (const auto& f : files) {
+        Sample s;
+        s.name = f.substr(f.find_last_of('/') + 1);
+        if (!boxes.empty() && !boxes.count(s.name)) continue;
+        s.frame = cv::imread(f, cv::IMREAD_COLOR);
+        if (s.frame.empty()) continue;
+        if (boxes.empty()) {
+            s.face = detector.getLargestDetection(s.frame);
+        } else {
+            s.face.box = boxes[s.name];
+        }
+        s.face.box &= cv::Rect(0, 0, s.frame.cols, s.frame.rows);
+        if (s.face.box.empty()) {
+            ++noFace;
+            continue;
+        }
+        samples.push_back(s);
+    }
+    if (noFace > 0) std::cout << "skipped " << noFace << " frames without a face" << std::endl;
+    return samples;
+}
+
+static FaceInput faceInput(const Sample& s) {
+    return FaceInput{s.frame, s.face.box, s.face.landmarks};
+}
+
+// Threshold stddev bergantung pada mode input, sama seperti FaceRecognitionServer
+static float configSpoofThreshold(const Config& cfg) {
+    return parseDepthInputMode(cfg.getString("depth_input_mode", "full")) == DepthInputMode::Roi
+        ? cfg.getFloat("spoof_threshold_roi", cfg.getFloat("spoof_threshold", 0.5f))
+        : cfg.getFloat("spoof_threshold", 0.5f);
+}
+
+static bool loadDepth(DepthAntiSpoofing& depth, const std::string& path, const Config& cfg) {
+    if (!depth.LoadModel(path)) return false;
+    depth.setInputMode(parseDepthInputMode(cfg.getString("depth_input_mode", "full")),
+                       cfg.getFloat("depth_roi_padding", 0.5f));
+    return true;
+}
+
+static bool loadEmbedder(FaceEmbedder& embedder, const std::string& path, const Config& cfg) {
+    embedder.setAlignment(cfg.getInt("face_alignment", 0) != 0);
+    return embedder.loadModel(path);
+}
+
+static bool writeRaw(const std::string& path, const float* data, size_t count) {
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(data), count * sizeof(float));
+    return static_cast<bool>(out);
+}
+
+static int cmdDump(const Config& cfg, std::map<std::string, std::string>& args) {
+    std::vector<Sample> samples = loadSamples(cfg, args);
+    if (samples.empty()) {
+        std::cerr << "No faces in " << args["frames"] << std::endl;
+        return 1;
+    }
+    const std::string out = args["out"];
+    ::mkdir(out.c_str(), 0755);
+    std::ofstream manifest(out + "/manifest.txt");
+
+    if (!args["embedder"].empty()) {
+        FaceEmbedder embedder;
+        if (!loadEmbedder(embedder, args["embedder"], cfg)) return 1;
+        ::mkdir((out + "/embedder").c_str(), 0755);
+        for (size_t i = 0; i < samples.size(); ++i) {
+            cv::Mat blob = embedder.inputBlob(faceInput(samples[i]));
+            std::string file = "embedder/" + std::to_string(i) + ".bin";
+            if (!writeRaw(out + "/" + file, blob.ptr<float>(), blob.total())) return 1;
+            manifest << "embedder " << file << " " << blob.size[0] << " " << blob.size[1] << " "
+                     << blob.size[2] << " " << blob.size[3] << "\n";
+        }
+        std::cout << "embedder: " << samples.size() << " tensors" << std::endl;
+    }
+
+    if (!args["depth"].empty()) {
+        DepthAntiSpoofing depth;
+        if (!loadDepth(depth, args["depth"], cfg)) return 1;
+        ::mkdir((out + "/depth").c_str(), 0755);
+        cv::Size size = depth.inputSize();
+        for (size_t i = 0; i < samples.size(); ++i) {
+            std::vector<float> tensor = depth.inputTensor(samples[i].frame, samples[i].face.box);
+            std::string file = "depth/" + std::to_string(i) + ".bin";
+            if (!writeRaw(out + "/" + file, tensor.data(), tensor.size())) return 1;
+            manifest << "depth " << file << " 1 3 " << size.height << " " << size.width << "\n";
+        }
+        std::cout << "depth: " << samples.size() << " tensors" << std::endl;
+    }
+    std::cout << "Calibration data: " << out << "/manifest.txt" << std::endl;
+    return 0;
+}
+
+static float percentile(std::vector<float> v, float p) {
+    if (v.empty()) return 0.0f;
+    std::sort(v.begin(), v.end());
+    size_t idx = static_cast<size_t>(p * (v.size() - 1) + 0.5f);
+    return v[idx];
+}
+
+static float mean(const std::vector<float>& v) {
+    return v.empty() ? 0.0f : std::accumulate(v.begin(), v.end(), 0.0f) / v.size();
+}
+
+static float flag(std::map<std::string, std::string>& args, const std::string& key, float def) {
+    return args[key].empty() ? def : std::stof(args[key]);
+}
+
+static bool reportEmbedder(const std::vector<Sample>& samples, const Config& cfg,
+                           std::map<std::string, std::string>& args) {
+    FaceEmbedder fp32, int8;
+    if (!loadEmbedder(fp32, args["embedder"], cfg) || !loadEmbedder(int8, args["embedder-int8"], cfg)) {
+        return false;
+    }
+
+    std::vector<std::vector<float>> a(samples.size()), b(samples.size());
+    double msA = 0.0, msB = 0.0;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        auto t0 = Clock::now();
+        a[i] = fp32.getNormalizedEmbedding(faceInput(samples[i]));
+        auto t1 = Clock::now();
+        b[i] = int8.getNormalizedEmbedding(faceInput(samples[i]));
+        auto t2 = Clock::now();
+        msA += std::chrono::duration<double, std::milli>(t1 - t0).count();
+        msB += std::chrono::duration<double, std::milli>(t2 - t1).count();
+    }
+
+    // Cosine fp32 vs int8 pada gambar yang sama = drift terhadap embedding DB yang sudah ada
+    std::vector<float> cosine;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        if (a[i].size() != b[i].size() || a[i].empty()) return false;
+        cosine.push_back(std::inner_product(a[i].begin(), a[i].end(), b[i].begin(), 0.0f));
+    }
+
+    // Top-1 tetangga terdekat antar gambar harus tetap sama
+    size_t top1Same = 0;
+    for (size_t i = 0; i < samples.size() && samples.size() > 1; ++i) {
+        size_t bestA = i, bestB = i;
+        float scoreA = -2.0f, scoreB = -2.0f;
+        for (size_t j = 0; j < samples.size(); ++j) {
+            if (j == i) continue;
+            float sa = std::inner_product(a[i].begin(), a[i].end(), a[j].begin(), 0.0f);
+            float sb = std::inner_product(b[i].begin(), b[i].end(), b[j].begin(), 0.0f);
+            if (sa > scoreA) { scoreA = sa; bestA = j; }
+            if (sb > scoreB) { scoreB = sb; bestB = j; }
+        }
+        if (bestA == bestB) ++top1Same;
+    }
+
+    float minCosine = flag(args, "min-cosine", 0.99f);
+    float minWorst = flag(args, "min-cosine-worst", 0.95f);
+    float worst = *std::min_element(cosine.begin(), cosine.end());
+    bool pass = mean(cosine) >= minCosine && worst >= minWorst;
+
+    std::cout << std::fixed << std::setprecision(4)
+              << "[embedder] images " << samples.size() << "\n"
+              << "  cosine fp32 vs int8: mean " << mean(cosine) << ", p5 " << percentile(cosine, 0.05f)
+              << ", worst " << worst << "  (gate: mean >= " << minCosine << ", worst >= " << minWorst << ")\n"
+              << "  nearest-neighbour agreement: " << top1Same << "/" << samples.size() << "\n"
+              << std::setprecision(2)
+              << "  latency: fp32 " << msA / samples.size() << " ms, int8 " << msB / samples.size() << " ms\n"
+              << "  => " << (pass ? "PASS" : "FAIL") << std::endl;
+    return pass;
+}
+
+static bool reportDepth(const std::vector<Sample>& samples, const Config& cfg,
+                        std::map<std::string, std::string>& args) {
+    DepthAntiSpoofing fp32, int8;
+    if (!loadDepth(fp32, args["depth"], cfg) || !loadDepth(int8, args["depth-int8"], cfg)) return false;
+
+    float threshold = flag(args, "spoof-threshold", configSpoofThreshold(cfg));
+    std::vector<float> drift;
+    size_t flips = 0;
+    double msA = 0.0, msB = 0.0;
+    for (const auto& s : samples) {
+        auto t0 = Clock::now();
+        float sa = fp32.faceDepthStddev(s.frame, s.face.box);
+        auto t1 = Clock::now();
+        float sb = int8.faceDepthStddev(s.frame, s.face.box);
+        auto t2 = Clock::now();
+        msA += std::chrono::duration<double, std::milli>(t1 - t0).count();
+        msB += std::chrono::duration<double, std::milli>(t2 - t1).count();
+        drift.push_back(std::fabs(sb - sa) / std::max(sa, 1e-6f));
+        if ((sa < threshold) != (sb < threshold)) ++flips;
+    }
+
+    float maxDrift = flag(args, "max-stddev-drift", 0.10f);
+    float maxFlip = flag(args, "max-flip-rate", 0.01f);
+    float flipRate = static_cast<float>(flips) / samples.size();
+    bool pass = mean(drift) <= maxDrift && flipRate <= maxFlip;
+
+    std::cout << std::fixed << std::setprecision(4)
+              << "[depth] input " << (fp32.inputMode() == DepthInputMode::Roi ? "roi" : "full")
+              << ", images " << samples.size() << "\n"
+              << "  relative stddev drift: mean " << mean(drift) << ", p95 " << percentile(drift, 0.95f)
+              << "  (gate: mean <= " << maxDrift << ")\n"
+              << "  spoof decision flips @" << threshold << ": " << flips << " (" << flipRate
+              << ", gate <= " << maxFlip << ")\n"
+              << std::setprecision(2)
+              << "  latency: fp32 " << msA / samples.size() << " ms, int8 " << msB / samples.size() << " ms\n"
+              << "  => " << (pass ? "PASS" : "FAIL") << std::endl;
+    return pass;
+}
+
+static int cmdReport(const Config& cfg, std::map<std::string, std::string>& args) {
+    std::vector<Sample> samples = loadSamples(cfg, args);
+    if (samples.empty()) {
+        std::cerr << "No faces in " << args["frames"] << std::endl;
+        return 1;
+    }
+
+    bool pass = true, any = false;
+    if (!args["embedder"].empty() && !args["embedder-int8"].empty()) {
+        pass = reportEmbedder(samples, cfg, args) && pass;
+        any = true;
+    }
+    if (!args["depth"].empty() && !args["depth-int8"].empty()) {
+        pass = reportDepth(samples, cfg, args) && pass;
+        any = true;
+    }
+    if (!any) return usage();
+    std::cout << (pass ? "RESULT: PASS" : "RESULT: FAIL") << std::endl;
+    return pass ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) return usage();
+    std::string cmd = argv[1];
+    std::map<std::string, std::string> args;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        std::string key = argv[i];
+        if (key.rfind("--", 0) != 0) return usage();
+        args[key.substr(2)] = argv[i + 1];
+    }
+    if (args["config"].empty() || args["frames"].empty()) return usage();
+
+    try {
+        Config cfg(args["config"]);
+        if (cmd == "dump" && !args["out"].empty()) return cmdDump(cfg, args);
+        if (cmd == "report") return cmdReport(cfg, args);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return usage();
+}
@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+"""Buat varian INT8 dari model ONNX (embedder ArcFace / Depth-Anything).
+
+Alur lengkap (lihat juga model_quant_tool):
+
+  1. model_quant_tool dump --faces crops/ --out calib/ --embedder fp32.onnx --depth fp32.onnx
+  2. python3 quantize_models.py --model arcfaceresnet100-8.onnx --calib calib/ --calib-key embedder \\
+         --mode static --out arcfaceresnet100-8.int8.onnx
+  3. model_quant_tool report --faces crops/ --embedder fp32.onnx --embedder-int8 int8.onnx
+     -> exit code 0 (PASS) baru model boleh dipakai (embedder_precision = int8)
+
+--mode static  : QDQ, aktivasi dikalibrasi dari tensor hasil dump (preprocess C++)
+--mode dynamic : hanya bobot INT8, aktivasi dikuantisasi saat runtime (tanpa kalibrasi)
+"""
+import argparse
+import os
+import sys
+
+import numpy as np
+import onnxruntime as ort
+from onnxruntime.quantization import (CalibrationDataReader, CalibrationMethod, QuantFormat,
+                                      QuantType, quantize_dynamic, quantize_static)
+from onnxruntime.quantization.shape_inference import quant_pre_process
+
+
+class ManifestReader(CalibrationDataReader):
+    """Membaca tensor kalibrasi dari manifest.txt: <key> <file> n c h w"""
+
+    def __init__(self, calib_dir, key, input_name, max_samples):
+        self.items = []
+        with open(os.path.join(calib_dir, "manifest.txt")) as f:
+            for line in f:
+                parts = line.split()
+                if len(parts) != 6 or parts[0] != key:
+                    continue
+                shape = tuple(int(x) for x in parts[2:])
+                self.items.append((os.path.join(calib_dir, parts[1]), shape))
+        self.items = self.items[:max_samples]
+        self.input_name = input_name
+        self.pos = 0
+
+    def get_next(self):
+        if self.pos >= len(self.items):
+            return None
+        path, shape = self.items[self.pos]
+        self.pos += 1
+        return {self.input_name: np.fromfile(path, dtype=np.float32).reshape(shape)}
+
+    def rewind(self):
+        self.pos = 0
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    p.add_argument("--model", required=True)
+    p.add_argument("--out", required=True)
+    p.add_argument("--mode", choices=["static", "dynamic"], default="static")
+    p.add_argument("--calib", help="folder hasil 'model_quant_tool dump' (mode static)")
+    p.add_argument("--calib-key", choices=["embedder", "depth"])
+    p.add_argument("--max-samples", type=int, default=256)
+    p.add_argument("--calib-method", choices=["minmax", "entropy", "percentile"], default="minmax")
+    p.add_argument("--per-channel", action="store_true", help="kuantisasi bobot per channel (akurasi lebih baik)")
+    args = p.parse_args()
+
+    prepped = args.out + ".prep.onnx"
+    quant_pre_process(args.model, prepped)
+
+    if args.mode == "dynamic":
+        quantize_dynamic(prepped, args.out, weight_type=QuantType.QInt8, per_channel=args.per_channel)
+    else:
+        if not args.calib or not args.calib_key:
+            p.error("--mode static requires --calib and --calib-key")
+        input_name = ort.InferenceSession(prepped, providers=["CPUExecutionProvider"]).get_inputs()[0].name
+        reader = ManifestReader(args.calib, args.calib_key, input_name, args.max_samples)
+        if not reader.items:
+            p.error(f"no '{args.calib_key}' tensors in {args.calib}/manifest.txt")
+        method = {"minmax": CalibrationMethod.MinMax, "entropy": CalibrationMethod.Entropy,
+                  "percentile": CalibrationMethod.Percentile}[args.calib_method]
+        quantize_static(prepped, args.out, reader, quant_format=QuantFormat.QDQ, per_channel=args.per_channel,
+                        activation_type=QuantType.QUInt8, weight_type=QuantType.QInt8, calibrate_method=method)
+        print(f"calibrated with {len(reader.items)} samples ({args.calib_method})")
+
+    os.remove(prepped)
+    size_in = os.path.getsize(args.model) / 1e6
+    size_out = os.path.getsize(args.out) / 1e6
+    print(f"{args.model} ({size_in:.1f} MB) -> {args.out} ({size_out:.1f} MB)")
+    print("Run 'model_quant_tool report' before enabling the INT8 model.")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -52,14 +52,14 @@ function stopCamera() {
     }
 }
 
-// Capture gambar dari video
-function captureImage() {
+// Capture gambar dari video sebagai JPEG biner (endpoint /v2, tanpa base64 / JSON)
+function captureJpeg() {
     if (!stream) {
         setResult('Kamera tidak aktif', 'error');
-        return null;
+        return Promise.resolve(null);
     }
     canvas.getContext('2d').drawImage(video, 0, 0, 640, 480);
-    return canvas.toDataURL('image/jpeg', 0.8).split(',')[1];
+    return new Promise(resolve => canvas.toBlob(resolve, 'image/jpeg', 0.8));
 }
 
 // Set hasil di result box
@@ -88,14 +88,14 @@ async function registerFace() {
         setResult('Nama harus diisi', 'error');
         return;
     }
-    const imageBase64 = captureImage();
-    if (!imageBase64) return;
+    const image = await captureJpeg();
+    if (!image) return;
 
     try {
-        const res = await fetch('http://localhost:8080/register', {
+        const res = await fetch('http://localhost:8080/v2/register?name=' + encodeURIComponent(name), {
             method: 'POST',
-            headers: { 'Content-Type': 'application/json' },
-            body: JSON.stringify({ name: name, image: imageBase64 })
+            headers: { 'Content-Type': 'image/jpeg' },
+            body: image
         });
         const result = await res.json();
         if (res.ok) {
@@ -112,14 +112,14 @@ async function registerFace() {
 
 // Verifikasi wajah
 async function verifyFace() {
-    const imageBase64 = captureImage();
-    if (!imageBase64) return;
+    const image = await captureJpeg();
+    if (!image) return;
 
     try {
-        const res = await fetch('http://localhost:8080/verify', {
+        const res = await fetch('http://localhost:8080/v2/verify', {
             method: 'POST',
-            headers: { 'Content-Type': 'application/json' },
-            body: JSON.stringify({ image: imageBase64 })
+            headers: { 'Content-Type': 'image/jpeg' },
+            body: image
         });
         const result = await res.json();
         if (res.ok) {